@@ -0,0 +1,897 @@
+// Benchmark harness: runs the BASIC corpus and a set of microbenchmarks
+// and prints the results as JSON, one object per benchmark, so that runs
+// of two commits can be compared with any JSON tool.
+//
+//     citbasic-bench [--repeat=N] [--corpus=DIR] [--filter=TEXT]
+//     citbasic-bench --alloc-check
+//     citbasic-bench --scheduler-check
+//     citbasic-bench --regression-check
+//
+// Every benchmark runs N times (5 by default) and reports its fastest
+// run. Allocation counts come from the replaced global operator new and
+// are those of the fastest run as well.
+//
+// --alloc-check runs loops of purely numeric statements instead and fails
+// when more iterations make more allocations, that is when such
+// statements still allocate once the run is warm.
+//
+// --scheduler-check runs many programs that wait on INPUT, SHELL and
+// channels through the Scheduler at once and fails unless every one of
+// them prints what it would have printed on a thread of its own.
+//
+// --regression-check runs short programs that once went wrong and fails
+// unless each prints, reports and returns what it should.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../src/AllocationProfiler.hpp"
+#include "../src/BatchRunner.hpp"
+#include "../src/Execution.hpp"
+#include "../src/MatKernels.hpp"
+#include "../src/Profiler.hpp"
+#include "../src/Program.hpp"
+#include "../src/Scheduler.hpp"
+#include "../src/Token.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(CITBASIC_ALLOC_TRACKING)
+
+// The core replaces operator new itself, and counts the calling thread
+// only.
+static AllocationProfiler::Count countAllocations()
+{
+    return AllocationProfiler::now();
+}
+
+#else
+
+static AllocationProfiler::Count g_allocations = { 0, 0 };
+
+void* operator new(std::size_t size)
+{
+    g_allocations.allocations++;
+    g_allocations.bytes += size;
+
+    void* p = std::malloc((0 == size) ? 1 : size);
+
+    if (nullptr == p)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+static AllocationProfiler::Count countAllocations()
+{
+    return g_allocations;
+}
+
+#endif
+
+
+// Swallows program output while a benchmark runs.
+class NullBuffer : public std::streambuf
+{
+protected:
+
+    int overflow(int c)
+    {
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count)
+    {
+        return count;
+    }
+};
+
+
+struct Result
+{
+    std::string   name;
+    std::string   unit;
+    std::uint64_t operations;
+    double        seconds;
+    std::uint64_t allocations;
+    std::uint64_t allocatedBytes;
+};
+
+
+static std::uint64_t peakResidentKilobytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+
+    if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage = {};
+
+    if (0 != ::getrusage(RUSAGE_SELF, &usage))
+        return 0;
+
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+
+class Bench
+{
+public:
+
+    Bench(unsigned repeat, const std::string& filter)
+        : m_repeat(repeat)
+        , m_filter(filter)
+        , m_first(true)
+    {
+    }
+
+    bool wants(const std::string& name) const
+    {
+        return m_filter.empty() || (std::string::npos != name.find(m_filter));
+    }
+
+    // Times body() m_repeat times; body performs the given number of
+    // operations per call.
+    template <typename Body>
+    void measure(
+        const std::string& name,
+        const std::string& unit,
+        std::uint64_t      operations,
+        Body               body)
+    {
+        Result best = { name, unit, operations, 0.0, 0, 0 };
+
+        for (unsigned i = 0; i < m_repeat; i++)
+        {
+            AllocationProfiler::Count before = countAllocations();
+
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto stop = std::chrono::steady_clock::now();
+
+            double seconds = std::chrono::duration<double>(stop - start).count();
+
+            if ((0 == i) || (seconds < best.seconds))
+            {
+                best.seconds = seconds;
+                AllocationProfiler::Count after = countAllocations();
+
+                best.allocations = after.allocations - before.allocations;
+                best.allocatedBytes = after.bytes - before.bytes;
+            }
+        }
+
+        print(best);
+    }
+
+    void finish()
+    {
+        std::cout << (m_first ? "[\n" : "\n") << "]\n";
+    }
+
+private:
+
+    void print(const Result& result)
+    {
+        double perOperation = (0 == result.operations)
+            ? 0.0 : result.seconds * 1e9 / result.operations;
+
+        double perSecond = (0.0 == result.seconds)
+            ? 0.0 : result.operations / result.seconds;
+
+        std::cout << (m_first ? "[\n" : ",\n")
+                  << "  {\"name\": \"" << result.name << "\""
+                  << ", \"unit\": \"" << result.unit << "\""
+                  << ", \"operations\": " << result.operations
+                  << ", \"seconds\": " << result.seconds
+                  << ", \"ns_per_operation\": " << perOperation
+                  << ", \"operations_per_second\": " << perSecond
+                  << ", \"allocations\": " << result.allocations
+                  << ", \"allocated_bytes\": " << result.allocatedBytes
+                  << ", \"peak_rss_kb\": " << peakResidentKilobytes()
+                  << "}";
+
+        std::cout.flush();
+        m_first = false;
+    }
+
+    unsigned    m_repeat;
+    std::string m_filter;
+    bool        m_first;
+};
+
+
+static bool loadProgram(Program& program, const std::string& text)
+{
+    std::istringstream stream(text);
+    return program.load(stream);
+}
+
+
+// Runs the program once under the profiler to learn how many lines it
+// executes, then times plain runs with the program output discarded.
+// Short programs run several passes per measurement.
+static void benchProgram(
+    Bench&             bench,
+    const std::string& name,
+    const std::string& text,
+    unsigned           passes = 1)
+{
+    NullBuffer nullBuffer;
+    std::ostream null(&nullBuffer);
+
+    Program program;
+
+    if (!loadProgram(program, text))
+    {
+        std::cerr << "Cannot load " << name << "!\n";
+        return;
+    }
+
+    Execution execution(program, std::cin, null, std::cerr);
+
+    Profiler profiler;
+    execution.setProfiler(&profiler);
+    bool isRun = execution.run();
+    execution.setProfiler(nullptr);
+
+    if (!isRun)
+    {
+        std::cerr << "Cannot run " << name << "!\n";
+        return;
+    }
+
+    bench.measure(name, "statement", passes * profiler.getTotalExecuted(), [&]()
+        {
+            for (unsigned i = 0; i < passes; i++)
+                execution.run();
+        });
+}
+
+
+// The same program as many jobs on every core, one Execution per job.
+static void benchBatch(
+    Bench&             bench,
+    const std::string& name,
+    const std::string& text)
+{
+    Program program;
+
+    if (!loadProgram(program, text))
+        return;
+
+    std::vector<BatchRunner::Job> jobs(256);
+    BatchRunner runner(program);
+
+    runner.run(jobs);
+
+    Profiler profiler;
+    NullBuffer nullBuffer;
+    std::ostream null(&nullBuffer);
+    Execution execution(program, std::cin, null, std::cerr);
+
+    execution.setProfiler(&profiler);
+    execution.run();
+
+    bench.measure(name, "statement", jobs.size() * profiler.getTotalExecuted(), [&]()
+        {
+            runner.run(jobs);
+        });
+}
+
+
+// A program of many distinct lines, for load time.
+static std::string generateProgram(std::size_t totalLines)
+{
+    std::ostringstream text;
+
+    for (std::size_t i = 0; i < totalLines; i++)
+    {
+        switch (i % 6)
+        {
+        case 0: text << "L" << i << ":\n"; break;
+        case 1: text << "A" << i % 97 << "% = A" << i % 89 << "% + " << i << " * 3\n"; break;
+        case 2: text << "X" << i % 53 << " = (X" << i % 47 << " + 1.5) / 2.25 - SQR(" << i << ")\n"; break;
+        case 3: text << "IF A" << i % 97 << "% > " << i << " THEN B% = 1 ELSE B% = 2\n"; break;
+        case 4: text << "S" << i % 31 << "$ = \"line " << i << "\" + LEFT$(T$, 3)\n"; break;
+        case 5: text << "' comment number " << i << "\n"; break;
+        }
+    }
+
+    return text.str();
+}
+
+
+static void benchTokenParse(Bench& bench)
+{
+    static const char line[] =
+        "IF (A% + 12) * B% >= LEN(N$) AND X < 3.25 THEN PRINT \"big\"; A% ELSE GOSUB Small";
+
+    const char* end = line + sizeof(line) - 1;
+    const std::uint64_t passes = 100000;
+
+    std::uint64_t tokens = 0;
+    Token token;
+
+    for (const char* current = token.parse(line, end);
+         Token::HAPPY_END != token.getType();
+         current = token.parse(current, end))
+    {
+        tokens++;
+    }
+
+    bench.measure("micro/token_parse", "token", passes * tokens, [&]()
+        {
+            for (std::uint64_t i = 0; i < passes; i++)
+            {
+                Token t;
+
+                for (const char* current = t.parse(line, end);
+                     Token::HAPPY_END != t.getType();
+                     current = t.parse(current, end))
+                {
+                }
+            }
+        });
+}
+
+
+static void benchLoad(Bench& bench)
+{
+    const std::size_t totalLines = 20000;
+    const std::string text = generateProgram(totalLines);
+
+    bench.measure("micro/load", "line", totalLines, [&]()
+        {
+            Program program;
+            loadProgram(program, text);
+        });
+}
+
+
+static void benchEvaluate(Bench& bench)
+{
+    std::string text("A = 1.5\nB = 4\nI% = 7\n");
+
+    for (int i = 0; i < 2000; i++)
+        text += "X = (A + 2.5) * (B - 1) / 3 + A ^ 2 - I% MOD 4\n";
+
+    benchProgram(bench, "micro/evaluate", text, 200);
+}
+
+
+static void benchGoto(Bench& bench)
+{
+    std::ostringstream text;
+
+    // Every line jumps to the next label, which sits on the line after.
+    for (int i = 0; i < 2000; i++)
+        text << "GOTO J" << i << "\nJ" << i << ":\n";
+
+    benchProgram(bench, "micro/goto", text.str(), 200);
+}
+
+
+static void benchMatKernels(Bench& bench)
+{
+    const std::size_t n = 4096;
+    const std::size_t side = 64;
+    const std::uint64_t passes = 200;
+
+    std::vector<double> a(side * side), b(side * side), c(side * side);
+
+    for (std::size_t i = 0; i < a.size(); i++)
+    {
+        a[i] = 0.5 * i;
+        b[i] = 1.0 / (i + 1);
+    }
+
+    MatKernels::Level best = MatKernels::detect();
+
+    for (int l = MatKernels::LEVEL_SCALAR; l <= best; l++)
+    {
+        MatKernels::Level level = static_cast<MatKernels::Level>(l);
+        const MatKernels::Table& table = MatKernels::table(level);
+        std::string prefix = std::string("mat/") + MatKernels::name(level) + "/";
+
+        if (bench.wants(prefix + "add"))
+        {
+            bench.measure(prefix + "add", "element", passes * n, [&]()
+                {
+                    for (std::uint64_t i = 0; i < passes; i++)
+                        table.addReal(&c[0], &a[0], &b[0], n);
+                });
+        }
+
+        if (bench.wants(prefix + "dot"))
+        {
+            volatile double sink = 0;
+
+            bench.measure(prefix + "dot", "element", passes * n, [&]()
+                {
+                    for (std::uint64_t i = 0; i < passes; i++)
+                        sink = sink + table.dotReal(&a[0], &b[0], n);
+                });
+        }
+
+        if (bench.wants(prefix + "multiply"))
+        {
+            bench.measure(prefix + "multiply", "multiply-add", 10 * side * side * side, [&]()
+                {
+                    for (int i = 0; i < 10; i++)
+                        table.multiplyReal(&c[0], &a[0], &b[0], side, side, side);
+                });
+        }
+    }
+}
+
+
+// Loops that read their number of iterations and then run nothing but
+// numeric statements.
+static const char* const NUMERIC_LOOPS[][2] =
+{
+    {
+        "integer",
+        "INPUT N%\n"
+        "I% = 0\n"
+        "S% = 0\n"
+        "Top:\n"
+        "I% = I% + 1\n"
+        "S% = S% + (I% * 3) MOD 7 - I% \\ 5\n"
+        "IF S% > 1000 THEN S% = 0 ELSE S% = S% + 1\n"
+        "IF I% < N% GOTO Top\n"
+    },
+    {
+        "real",
+        "INPUT N%\n"
+        "I% = 0\n"
+        "X = 0.5\n"
+        "Top:\n"
+        "I% = I% + 1\n"
+        "X = X * 1.0001 + SQR(I%) - INT(X / 3)\n"
+        "Y = ABS(SIN(X)) ^ 2 + COS(Y)\n"
+        "IF X > 1000000 AND NOT (I% < 0) THEN X = 0.5\n"
+        "IF I% < N% GOTO Top\n"
+    },
+    {
+        "array",
+        "INPUT N%\n"
+        "DIM A(15), B%(3, 3)\n"
+        "I% = 0\n"
+        "Top:\n"
+        "I% = I% + 1\n"
+        "A(I% MOD 16) = A((I% + 1) MOD 16) + I% / 2\n"
+        "B%(I% MOD 4, (I% \\ 4) MOD 4) = B%(1, 2) + 1\n"
+        "IF I% < N% GOTO Top\n"
+    },
+    {
+        "gosub",
+        "INPUT N%\n"
+        "I% = 0\n"
+        "Top:\n"
+        "GOSUB Advance\n"
+        "IF I% < N% GOTO Top\n"
+        "END\n"
+        "Advance:\n"
+        "I% = I% + 1\n"
+        "RETURN\n"
+    }
+};
+
+
+// Allocations of one run of the program with the given input.
+static AllocationProfiler::Count countRun(
+    const Program&     program,
+    const std::string& input,
+    bool&              isRun)
+{
+    NullBuffer nullBuffer;
+    std::ostream null(&nullBuffer);
+    std::istringstream in(input);
+
+    Execution execution(program, in, null, std::cerr);
+
+    AllocationProfiler::Count before = countAllocations();
+    isRun = execution.run();
+    AllocationProfiler::Count after = countAllocations();
+
+    after.allocations -= before.allocations;
+    after.bytes -= before.bytes;
+    return after;
+}
+
+
+// Runs every loop for a few iterations to warm up, then for 1000 and for
+// 2000; the two must allocate the same.
+static int checkAllocations()
+{
+    bool isPassed = true;
+
+    for (std::size_t i = 0; i < sizeof(NUMERIC_LOOPS) / sizeof(NUMERIC_LOOPS[0]); i++)
+    {
+        Program program;
+
+        if (!loadProgram(program, NUMERIC_LOOPS[i][1]))
+        {
+            std::cerr << "Cannot load " << NUMERIC_LOOPS[i][0] << "!\n";
+            return 1;
+        }
+
+        bool isRun[3];
+
+        countRun(program, "10\n", isRun[0]);
+        AllocationProfiler::Count shorter = countRun(program, "1000\n", isRun[1]);
+        AllocationProfiler::Count longer = countRun(program, "2000\n", isRun[2]);
+
+        if (!isRun[0] || !isRun[1] || !isRun[2])
+        {
+            std::cerr << "Cannot run " << NUMERIC_LOOPS[i][0] << "!\n";
+            return 1;
+        }
+
+        std::uint64_t extra = longer.allocations - shorter.allocations;
+
+        std::cout << NUMERIC_LOOPS[i][0] << ": "
+                  << extra << " allocations in 1000 more iterations"
+                  << ((0 == extra) ? "" : " FAILED") << "\n";
+
+        isPassed = isPassed && (0 == extra);
+    }
+
+    return isPassed ? 0 : 1;
+}
+
+
+// Programs for the scheduler check. ECHO waits for its input and then for
+// a child process; PRODUCER and CONSUMER stream 1 to N% over a channel
+// too small to hold them, so that both sides keep waiting on each other.
+static const char* const ECHO =
+    "INPUT A$\n"
+    "B$ = SHELL$(\"echo \" + A$)\n"
+    "PRINT B$ + \".\"\n";
+
+static const char* const PRODUCER =
+    "INPUT C$, N%\n"
+    "I% = 0\n"
+    "Top:\n"
+    "I% = I% + 1\n"
+    "SEND C$, I%\n"
+    "IF I% < N% GOTO Top\n";
+
+static const char* const CONSUMER =
+    "INPUT C$, N%\n"
+    "I% = 0\n"
+    "S% = 0\n"
+    "Top:\n"
+    "RECEIVE C$, X%\n"
+    "S% = S% + X%\n"
+    "I% = I% + 1\n"
+    "IF I% < N% GOTO Top\n"
+    "PRINT S%\n";
+
+static const char* const RUNAWAY =
+    "Top:\n"
+    "GOTO Top\n";
+
+
+// One run of the scheduler check and the output it must end with.
+struct ScheduledRun
+{
+    Scheduler::Id      id;
+    std::ostringstream out;
+    std::ostringstream err;
+    std::string        expected;
+};
+
+
+// Spawns 256 ECHO runs and 256 PRODUCER/CONSUMER pairs on two threads,
+// feeds them and compares what each printed; then checks that a runaway
+// loop spawned under a statement limit fails instead of running forever.
+static int checkScheduler()
+{
+    static const unsigned TOTAL_ECHOES = 256;
+    static const unsigned TOTAL_PAIRS  = 256;
+    static const unsigned TOTAL_VALUES = 1000;
+
+    Program echo;
+    Program producer;
+    Program consumer;
+    Program runaway;
+
+    if (!loadProgram(echo, ECHO) || !loadProgram(producer, PRODUCER) ||
+        !loadProgram(consumer, CONSUMER) || !loadProgram(runaway, RUNAWAY))
+    {
+        std::cerr << "Cannot load the scheduler check!\n";
+        return 1;
+    }
+
+    Channels channels;
+    Scheduler scheduler(2);
+    std::vector<std::unique_ptr<ScheduledRun>> runs;
+
+    for (unsigned i = 0; i < TOTAL_ECHOES; i++)
+    {
+        std::unique_ptr<ScheduledRun> run(new ScheduledRun);
+        std::string text = "run" + std::to_string(i);
+
+        run->id = scheduler.spawn(echo, run->out, run->err, &channels);
+        run->expected = text + ". \n";
+        scheduler.feed(run->id, text + "\n");
+        scheduler.closeInput(run->id);
+        runs.push_back(std::move(run));
+    }
+
+    for (unsigned i = 0; i < TOTAL_PAIRS; i++)
+    {
+        std::string name = "pipe" + std::to_string(i);
+        std::string input = name + " " + std::to_string(TOTAL_VALUES) + "\n";
+
+        channels.open(name, 4);
+
+        std::unique_ptr<ScheduledRun> sender(new ScheduledRun);
+        std::unique_ptr<ScheduledRun> receiver(new ScheduledRun);
+
+        sender->id = scheduler.spawn(producer, sender->out, sender->err, &channels);
+        receiver->id = scheduler.spawn(consumer, receiver->out, receiver->err, &channels);
+        receiver->expected = std::to_string(TOTAL_VALUES * (TOTAL_VALUES + 1) / 2) + " \n";
+
+        scheduler.feed(receiver->id, input);
+        scheduler.closeInput(receiver->id);
+        scheduler.feed(sender->id, input);
+        scheduler.closeInput(sender->id);
+
+        runs.push_back(std::move(sender));
+        runs.push_back(std::move(receiver));
+    }
+
+    unsigned totalFailed = 0;
+
+    for (std::size_t i = 0; i < runs.size(); i++)
+    {
+        bool isRun = scheduler.wait(runs[i]->id);
+
+        if (!isRun || (runs[i]->expected != runs[i]->out.str()))
+        {
+            if (0 == totalFailed)
+                std::cerr << "Run " << i << " printed \"" << runs[i]->out.str()
+                          << "\" instead of \"" << runs[i]->expected << "\": "
+                          << runs[i]->err.str() << "\n";
+
+            totalFailed++;
+        }
+    }
+
+    std::cout << "scheduler: " << totalFailed << " of " << runs.size()
+              << " runs printed the wrong output"
+              << ((0 == totalFailed) ? "" : " FAILED") << "\n";
+
+    Governor::Limits limits;
+    limits.statements = 100000;
+    scheduler.setLimits(limits);
+
+    ScheduledRun stopped;
+    stopped.id = scheduler.spawn(runaway, stopped.out, stopped.err, &channels);
+    scheduler.closeInput(stopped.id);
+
+    bool isStopped = !scheduler.wait(stopped.id);
+
+    std::cout << "scheduler: a runaway loop under a statement limit "
+              << (isStopped ? "was stopped" : "ran to its end FAILED") << "\n";
+
+    return ((0 == totalFailed) && isStopped) ? 0 : 1;
+}
+
+
+// A program of the regression check, the limit on its memory (none when
+// zero), what it must print and report, and whether it must run to its end.
+struct Regression
+{
+    const char*  name;
+    const char*  text;
+    std::size_t  memoryBytes;
+    const char*  out;
+    const char*  err;
+    bool         isRun;
+};
+
+static const Regression REGRESSIONS[] =
+{
+    {
+        "mat_target_over_limit",
+        "DIM X(2000, 0), Y(0, 2000)\n"
+        "MAT Z = X * Y\n"
+        "PRINT \"done\"\n",
+        100000, "", "Memory limit exceeded!\n", false
+    },
+    {
+        "mat_target_charged",
+        "DIM X%(99, 0), Y%(0, 99)\n"
+        "MAT Z% = X% * Y%\n"
+        "PRINT \"multiplied\"\n"
+        "DIM W%(3000)\n"
+        "PRINT \"done\"\n",
+        100000, "multiplied \n", "Memory limit exceeded!\n", false
+    },
+    {
+        "val_not_a_number",
+        "X = VAL(\"abc\")\n"
+        "PRINT \"done\"\n",
+        0, "", "Bad number in VAL!\n", false
+    },
+    {
+        "array_element_precision",
+        "DIM A(3)\n"
+        "A(1) = 0.1\n"
+        "X = 0.1\n"
+        "IF A(1) = X THEN PRINT \"equal\" ELSE PRINT \"different\"\n",
+        0, "equal \n", "", true
+    }
+};
+
+
+static int checkRegressions()
+{
+    unsigned totalFailed = 0;
+
+    for (std::size_t i = 0; i < sizeof(REGRESSIONS) / sizeof(REGRESSIONS[0]); i++)
+    {
+        const Regression& regression = REGRESSIONS[i];
+        Program program;
+
+        if (!loadProgram(program, regression.text))
+        {
+            std::cerr << "Cannot load " << regression.name << "!\n";
+            return 1;
+        }
+
+        std::istringstream in;
+        std::ostringstream out;
+        std::ostringstream err;
+
+        Execution execution(program, in, out, err);
+
+        Governor::Limits limits;
+        limits.memoryBytes = regression.memoryBytes;
+        execution.setLimits(limits);
+
+        bool isRun = execution.run();
+        bool isPassed = (regression.isRun == isRun) &&
+            (regression.out == out.str()) &&
+            (std::string::npos != err.str().find(regression.err));
+
+        std::cout << regression.name << ": "
+                  << (isPassed ? "passed" : "FAILED") << "\n";
+
+        if (!isPassed)
+        {
+            std::cerr << "Printed \"" << out.str() << "\" and reported \""
+                      << err.str() << "\"\n";
+            totalFailed++;
+        }
+    }
+
+    return (0 == totalFailed) ? 0 : 1;
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned repeat = 5;
+    std::string corpus("bench/corpus");
+    std::string filter;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+
+        if (0 == argument.compare(0, 9, "--repeat="))
+            repeat = static_cast<unsigned>(std::stoul(argument.substr(9)));
+        else if (0 == argument.compare(0, 9, "--corpus="))
+            corpus = argument.substr(9);
+        else if (0 == argument.compare(0, 9, "--filter="))
+            filter = argument.substr(9);
+        else if ("--alloc-check" == argument)
+            return checkAllocations();
+        else if ("--scheduler-check" == argument)
+            return checkScheduler();
+        else if ("--regression-check" == argument)
+            return checkRegressions();
+        else
+        {
+            std::cerr << "Usage: citbasic-bench [--repeat=N] [--corpus=DIR] [--filter=TEXT]\n"
+                      << "       citbasic-bench --alloc-check\n"
+                      << "       citbasic-bench --scheduler-check\n"
+                      << "       citbasic-bench --regression-check\n";
+            return 1;
+        }
+    }
+
+    Bench bench((0 == repeat) ? 1 : repeat, filter);
+
+    static const char* const programs[] =
+    {
+        "int_loops",
+        "real_math",
+        "strings",
+        "gosub",
+        "print_heavy",
+        "mat_loops",
+        "mat_kernels"
+    };
+
+    for (std::size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++)
+    {
+        std::string name = std::string("corpus/") + programs[i];
+
+        if (!bench.wants(name))
+            continue;
+
+        std::ifstream file((corpus + "/" + programs[i] + ".bas").c_str(), std::ios::in);
+
+        if (!file.is_open())
+        {
+            std::cerr << "Cannot open \"" << corpus << "/" << programs[i] << ".bas\"!\n";
+            return 1;
+        }
+
+        std::stringstream text;
+        text << file.rdbuf();
+
+        benchProgram(bench, name, text.str());
+
+        if (("gosub" == std::string(programs[i])) && bench.wants("batch/gosub"))
+            benchBatch(bench, "batch/gosub", text.str());
+    }
+
+    if (bench.wants("micro/token_parse"))
+        benchTokenParse(bench);
+
+    if (bench.wants("micro/load"))
+        benchLoad(bench);
+
+    if (bench.wants("micro/evaluate"))
+        benchEvaluate(bench);
+
+    if (bench.wants("micro/goto"))
+        benchGoto(bench);
+
+    benchMatKernels(bench);
+
+    bench.finish();
+    return 0;
+}
@@ -0,0 +1,23 @@
+' Subroutine calls nested three deep.
+S% = 0
+I% = 0
+Again:
+GOSUB First
+I% = I% + 1
+IF I% < 30000 GOTO Again
+PRINT "sum"; S%
+END
+
+First:
+S% = S% + 1
+GOSUB Second
+RETURN
+
+Second:
+S% = S% + 2
+GOSUB Third
+RETURN
+
+Third:
+S% = S% + I% MOD 3
+RETURN
@@ -0,0 +1,12 @@
+' Nested integer loops: counters, MOD and integer division.
+S% = 0
+I% = 0
+Outer:
+J% = 0
+Inner:
+S% = S% + (I% * J%) MOD 7 + J% \ 3
+J% = J% + 1
+IF J% < 300 GOTO Inner
+I% = I% + 1
+IF I% < 300 GOTO Outer
+PRINT "sum"; S%
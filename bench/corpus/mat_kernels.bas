@@ -0,0 +1,25 @@
+' Whole-array arithmetic through MAT. Computes the same results as
+' mat_loops.bas so the two can be timed against each other.
+N% = 20000
+R% = 5
+DIM A(N%), B(N%)
+I% = 0
+Fill:
+A(I%) = I% * 0.5
+B(I%) = N% - I%
+I% = I% + 1
+IF I% <= N% GOTO Fill
+
+K% = 0
+Repeat:
+MAT C = A + B
+MAT C = (0.25) * C
+MAT D = C - A
+MAT P = DOT(C, D)
+MAT S = SUM(D)
+MAT L = MIN(D)
+MAT H = MAX(C)
+K% = K% + 1
+IF K% < R% GOTO Repeat
+
+PRINT "dot"; P; "sum"; S; "min"; L; "max"; H
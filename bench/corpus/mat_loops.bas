@@ -0,0 +1,31 @@
+' Explicit element loops equivalent to mat_kernels.bas.
+N% = 20000
+R% = 5
+DIM A(N%), B(N%), C(N%), D(N%)
+I% = 0
+Fill:
+A(I%) = I% * 0.5
+B(I%) = N% - I%
+I% = I% + 1
+IF I% <= N% GOTO Fill
+
+K% = 0
+Repeat:
+P = 0
+S = 0
+L = 1000000000
+H = -1000000000
+I% = 0
+Element:
+C(I%) = (A(I%) + B(I%)) * 0.25
+D(I%) = C(I%) - A(I%)
+P = P + C(I%) * D(I%)
+S = S + D(I%)
+IF D(I%) < L THEN L = D(I%)
+IF C(I%) > H THEN H = C(I%)
+I% = I% + 1
+IF I% <= N% GOTO Element
+K% = K% + 1
+IF K% < R% GOTO Repeat
+
+PRINT "dot"; P; "sum"; S; "min"; L; "max"; H
@@ -0,0 +1,6 @@
+' Formatted output of mixed values; run it with output redirected.
+I% = 0
+Row:
+PRINT "row"; I%; " value"; I% * 0.5; " "; LEFT$("abcdefghij", I% MOD 10)
+I% = I% + 1
+IF I% < 20000 GOTO Row
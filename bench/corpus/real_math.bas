@@ -0,0 +1,10 @@
+' Floating point expressions and built-in math functions.
+X = 0
+S = 0
+I% = 0
+Sample:
+X = I% * 0.001
+S = S + SIN(X) * COS(X) + SQR(X + 1) - LOG(X + 1) + ATN(X) / (1 + X ^ 2)
+I% = I% + 1
+IF I% < 50000 GOTO Sample
+PRINT "sum"; S
@@ -0,0 +1,13 @@
+' String building, slicing and searching.
+A$ = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+T$ = ""
+N% = 0
+I% = 0
+Build:
+T$ = T$ + MID$(A$, I% MOD 26 + 1, 1)
+IF LEN(T$) > 200 THEN T$ = MID$(T$, 50, 100)
+W$ = UCASE$(LEFT$(T$, 8)) + LCASE$(RIGHT$(T$, 8))
+IF INSTR(T$, "XYZ") > 0 THEN N% = N% + 1
+I% = I% + 1
+IF I% < 40000 GOTO Build
+PRINT "found"; N%; " "; W$
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include "AllocationProfiler.hpp"
+#include "Program.hpp"
+
+#if defined(CITBASIC_ALLOC_TRACKING)
+
+static thread_local AllocationProfiler::Count t_count = { 0, 0 };
+
+// Every form of new ends up here or in the aligned forms, which are left
+// alone; the sizes freed are not known, so only allocations are counted.
+void* operator new(std::size_t size)
+{
+    t_count.allocations++;
+    t_count.bytes += size;
+
+    void* p = std::malloc((0 == size) ? 1 : size);
+
+    if (nullptr == p)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+bool AllocationProfiler::isTracking()
+{
+    return true;
+}
+
+
+AllocationProfiler::Count AllocationProfiler::now()
+{
+    return t_count;
+}
+
+#else
+
+bool AllocationProfiler::isTracking()
+{
+    return false;
+}
+
+
+AllocationProfiler::Count AllocationProfiler::now()
+{
+    Count count = { 0, 0 };
+    return count;
+}
+
+#endif
+
+
+void AllocationProfiler::reset(std::size_t totalLines)
+{
+    Line empty = { 0, 0, 0 };
+
+    m_lines.assign(totalLines, empty);
+    std::fill(m_kinds, m_kinds + TOTAL_KINDS, empty);
+}
+
+
+void AllocationProfiler::report(
+    std::ostream&  stream,
+    const Program& program) const
+{
+    std::vector<std::size_t> lines;
+    std::uint64_t statements = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+
+    for (std::size_t i = 0; i < m_lines.size(); i++)
+    {
+        if (0 != m_lines[i].count)
+        {
+            lines.push_back(i);
+            statements += m_lines[i].count;
+            allocations += m_lines[i].allocations;
+            bytes += m_lines[i].bytes;
+        }
+    }
+
+    std::stable_sort(lines.begin(), lines.end(),
+        [this](std::size_t a, std::size_t b) -> bool
+        {
+            return m_lines[a].allocations > m_lines[b].allocations;
+        });
+
+    stream << "Allocations: " << statements << " lines executed, "
+           << allocations << " allocations, " << bytes << " bytes";
+
+    if (!isTracking())
+        stream << " (not counted in this build)";
+
+    stream << "\n\n" << std::setw(12) << "Statement" << " "
+           << std::setw(12) << "Count" << " "
+           << std::setw(14) << "Allocations" << " "
+           << std::setw(16) << "Bytes" << " "
+           << std::setw(10) << "Average" << "\n";
+
+    for (std::size_t i = 0; i < TOTAL_KINDS; i++)
+    {
+        const Line& entry = m_kinds[i];
+
+        if (0 == entry.count)
+            continue;
+
+        stream << std::setw(12)
+               << ((TOTAL_KINDS - 1 == i) ? "(assignment)" : Token::getKeywordName(
+                    static_cast<Token::Value>(Token::TYPE_KEYWORD + 1 + i))) << " "
+               << std::setw(12) << entry.count << " "
+               << std::setw(14) << entry.allocations << " "
+               << std::setw(16) << entry.bytes << " "
+               << std::setw(10) << std::fixed << std::setprecision(2)
+               << static_cast<double>(entry.allocations) / entry.count << "\n";
+    }
+
+    stream << "\n" << std::setw(6) << "Line" << " "
+           << std::setw(12) << "Count" << " "
+           << std::setw(14) << "Allocations" << " "
+           << std::setw(16) << "Bytes" << " "
+           << std::setw(10) << "Average" << "  Source\n";
+
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        const Line& entry = m_lines[lines[i]];
+
+        stream << std::setw(6)  << program.getLineNumber(lines[i]) << " "
+               << std::setw(12) << entry.count << " "
+               << std::setw(14) << entry.allocations << " "
+               << std::setw(16) << entry.bytes << " "
+               << std::setw(10) << std::fixed << std::setprecision(2)
+               << static_cast<double>(entry.allocations) / entry.count << "  "
+               << program.getSourceLine(lines[i]) << "\n";
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef ALLOCATION_PROFILER_HPP_INCLUDED
+#define ALLOCATION_PROFILER_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Token.hpp"
+
+class Program;
+
+// Heap allocations made by each line and by each kind of statement. The
+// counts come from the global operator new of the allocation-tracking
+// build (CITBASIC_ALLOC_TRACKING), which counts the allocations of every
+// thread on its own; other builds have nothing to count.
+class AllocationProfiler
+{
+public:
+
+    struct Count
+    {
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+    };
+
+    // Whether this build counts allocations.
+    static bool isTracking();
+
+    // What the calling thread has allocated so far.
+    static Count now();
+
+    void reset(std::size_t totalLines);
+
+    // Accounts one executed line, first being the token it starts with.
+    void record(
+        std::size_t  line,
+        const Token& first,
+        const Count& start,
+        const Count& stop)
+    {
+        std::size_t kind = (Token::TYPE_KEYWORD == first.getType())
+            ? first.getValue() - Token::TYPE_KEYWORD - 1
+            : TOTAL_KINDS - 1;
+
+        account(m_lines[line], start, stop);
+        account(m_kinds[kind], start, stop);
+    }
+
+    void report(std::ostream& stream, const Program& program) const;
+
+private:
+
+    // The keywords, then assignments.
+    static const std::size_t TOTAL_KINDS = Token::KEYWORD_TO - Token::TYPE_KEYWORD + 1;
+
+    struct Line
+    {
+        std::uint64_t count;
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+    };
+
+    static void account(Line& entry, const Count& start, const Count& stop)
+    {
+        entry.count++;
+        entry.allocations += stop.allocations - start.allocations;
+        entry.bytes += stop.bytes - start.bytes;
+    }
+
+    std::vector<Line> m_lines;
+    Line              m_kinds[TOTAL_KINDS];
+};
+
+#endif // ALLOCATION_PROFILER_HPP_INCLUDED
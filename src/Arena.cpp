@@ -0,0 +1,67 @@
+#include <algorithm>
+#include "Arena.hpp"
+
+Arena::Arena(std::size_t blockBytes) : m_blockBytes(blockBytes)
+{
+    build();
+}
+
+
+void Arena::build()
+{
+    // The pool goes first, as it hands its chunks back to the block.
+    m_pool.reset();
+    m_monotonic.reset();
+
+    m_block.reset(new char[m_blockBytes]);
+    m_monotonic.reset(new std::pmr::monotonic_buffer_resource(
+        m_block.get(), m_blockBytes, &m_overflow));
+
+    std::pmr::pool_options options;
+    options.largest_required_pool_block = MAX_POOLED_BYTES;
+
+    m_pool.reset(new std::pmr::unsynchronized_pool_resource(options, m_monotonic.get()));
+    m_overflow.clear();
+}
+
+
+void Arena::rewind()
+{
+    std::size_t overflow = m_overflow.getBytes();
+    std::size_t limit = MAX_BLOCK_BYTES;
+
+    if ((0 != overflow) && (m_blockBytes < limit))
+    {
+        m_blockBytes = std::min(m_blockBytes + overflow, limit);
+        build();
+        return;
+    }
+
+    m_pool->release();
+    m_monotonic->release();
+    m_overflow.clear();
+}
+
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (bytes > MAX_POOLED_BYTES)
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+
+    return m_pool->allocate(bytes, alignment);
+}
+
+
+void Arena::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    if (bytes > MAX_POOLED_BYTES)
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    else
+        m_pool->deallocate(p, bytes, alignment);
+}
+
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
@@ -0,0 +1,90 @@
+#ifndef ARENA_HPP_INCLUDED
+#define ARENA_HPP_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Memory of one run at a time. The variables, arrays, string contents and
+// working stacks of an Execution are carved from a block kept from run to
+// run, and rewind() takes all of it back at once. Small blocks go through
+// a pool first, so that a long run reuses what it frees; blocks over
+// MAX_POOLED_BYTES, big arrays mostly, come from the heap as before.
+//
+// A run that needs more than the block takes the rest from the heap, and
+// the next rewind() grows the block to match, up to MAX_BLOCK_BYTES; runs
+// alike soon allocate nothing at all. An arena serves one execution at a
+// time, on one thread at a time.
+class Arena : public std::pmr::memory_resource
+{
+public:
+
+    static const std::size_t DEFAULT_BYTES = 16 * 1024;
+    static const std::size_t MAX_BLOCK_BYTES = 16 * 1024 * 1024;
+    static const std::size_t MAX_POOLED_BYTES = 64 * 1024;
+
+    explicit Arena(std::size_t blockBytes = DEFAULT_BYTES);
+
+    // Whatever was allocated from the arena must have been freed, or must
+    // never be touched again; the blocks over MAX_POOLED_BYTES must have
+    // been freed.
+    void rewind();
+
+    std::size_t getBlockBytes() const { return m_blockBytes; }
+
+protected:
+
+    virtual void* do_allocate(std::size_t bytes, std::size_t alignment);
+    virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment);
+    virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept;
+
+private:
+
+    Arena(const Arena&);
+    Arena& operator =(const Arena&);
+
+    // The heap, for what does not fit the block, counting what it gives.
+    class Overflow : public std::pmr::memory_resource
+    {
+    public:
+
+        Overflow() : m_bytes(0) {}
+
+        std::size_t getBytes() const { return m_bytes; }
+        void clear() { m_bytes = 0; }
+
+    protected:
+
+        virtual void* do_allocate(std::size_t bytes, std::size_t alignment)
+        {
+            void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            m_bytes += bytes;
+            return p;
+        }
+
+        virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+        {
+            return this == &other;
+        }
+
+    private:
+
+        std::size_t m_bytes;
+    };
+
+    void build();
+
+    std::unique_ptr<char[]> m_block;
+    std::size_t             m_blockBytes;
+    Overflow                m_overflow;
+
+    std::unique_ptr<std::pmr::monotonic_buffer_resource>    m_monotonic;
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> m_pool;
+};
+
+#endif // ARENA_HPP_INCLUDED
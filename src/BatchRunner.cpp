@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <thread>
+#include "BatchRunner.hpp"
+#include "Execution.hpp"
+
+BatchRunner::BatchRunner(const Program& program, unsigned totalThreads)
+    : m_program(program)
+    , m_totalThreads(totalThreads)
+    , m_isSeeded(false)
+    , m_seed(0)
+{
+    if (0 == m_totalThreads)
+        m_totalThreads = std::thread::hardware_concurrency();
+
+    if (0 == m_totalThreads)
+        m_totalThreads = 1;
+}
+
+
+void BatchRunner::run(std::vector<Job>& jobs) const
+{
+    std::atomic<std::size_t> next(0);
+
+    auto work = [&]()
+    {
+        Arena arena;
+
+        for (std::size_t i = next++; i < jobs.size(); i = next++)
+        {
+            Job& job = jobs[i];
+
+            std::istringstream in(job.input);
+            std::ostringstream out;
+            std::ostringstream err;
+
+            Execution execution(m_program, in, out, err, &arena);
+            execution.setLimits(m_limits);
+
+            if (m_isSeeded)
+                execution.setSeed(m_seed + i);
+
+            // One bad job fails alone.
+            try
+            {
+                job.isDone = execution.run();
+            }
+            catch (const std::exception&)
+            {
+                job.isDone = false;
+                err << "Internal error!\n";
+            }
+
+            job.output = out.str();
+            job.errors = err.str();
+        }
+    };
+
+    std::size_t totalThreads = std::min<std::size_t>(m_totalThreads, jobs.size());
+    std::vector<std::thread> threads;
+
+    // The calling thread works too.
+    for (std::size_t i = 1; i < totalThreads; i++)
+        threads.push_back(std::thread(work));
+
+    work();
+
+    for (std::size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
@@ -0,0 +1,53 @@
+#ifndef BATCH_RUNNER_HPP_INCLUDED
+#define BATCH_RUNNER_HPP_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Governor.hpp"
+#include "Program.hpp"
+
+// Runs one program over many jobs on all cores. Every job gets a fresh
+// Execution reading its own input and writing its own output; the program
+// is loaded once and shared by all of them.
+class BatchRunner
+{
+public:
+
+    struct Job
+    {
+        std::string input;   // what INPUT statements read
+        std::string output;  // what the program printed
+        std::string errors;  // error messages, if any
+        bool        isDone;  // the program ran to its end
+    };
+
+    // totalThreads of zero uses one thread per hardware thread.
+    explicit BatchRunner(const Program& program, unsigned totalThreads = 0);
+
+    // Job i starts RND from seed + i, so batches can be repeated.
+    void setSeed(std::uint64_t seed) { m_seed = seed; m_isSeeded = true; }
+
+    // Applied to each run on its own.
+    void setLimits(const Governor::Limits& limits) { m_limits = limits; }
+
+    unsigned getTotalThreads() const { return m_totalThreads; }
+
+    // Returns once every job has run; jobs are handed out in order to
+    // whichever thread is free.
+    void run(std::vector<Job>& jobs) const;
+
+private:
+
+    BatchRunner(const BatchRunner&);
+    BatchRunner& operator =(const BatchRunner&);
+
+    const Program& m_program;
+    unsigned       m_totalThreads;
+    bool           m_isSeeded;
+    std::uint64_t  m_seed;
+
+    Governor::Limits m_limits;
+};
+
+#endif // BATCH_RUNNER_HPP_INCLUDED
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <condition_variable>
+#include "Channel.hpp"
+
+Channel::Channel(std::size_t capacity, Kind kind)
+    : m_kind(kind)
+    , m_isClosed(false)
+    , m_totalWaiters(0)
+{
+    if (KIND_SPSC == m_kind)
+        m_spsc.reset(new SpscRing<Message>(std::max<std::size_t>(capacity, 1)));
+    else
+        m_mpmc.reset(new MpmcRing<Message>(std::max<std::size_t>(capacity, 2)));
+}
+
+
+bool Channel::trySend(Message& message)
+{
+    if (isClosed())
+        return false;
+
+    bool isSent = (KIND_SPSC == m_kind)
+        ? m_spsc->push(message)
+        : m_mpmc->push(message);
+
+    if (isSent)
+        notify();
+
+    return isSent;
+}
+
+
+bool Channel::tryReceive(Message& message)
+{
+    bool isReceived = (KIND_SPSC == m_kind)
+        ? m_spsc->pop(message)
+        : m_mpmc->pop(message);
+
+    if (isReceived)
+        notify();
+
+    return isReceived;
+}
+
+
+bool Channel::send(Message& message)
+{
+    while (!trySend(message))
+    {
+        if (isClosed())
+            return false;
+
+        block(true);
+    }
+
+    return true;
+}
+
+
+bool Channel::receive(Message& message)
+{
+    while (!tryReceive(message))
+    {
+        if (isClosed())
+            return tryReceive(message);
+
+        block(false);
+    }
+
+    return true;
+}
+
+
+void Channel::close()
+{
+    m_isClosed.store(true);
+    notify();
+}
+
+
+bool Channel::isReady(bool forSend) const
+{
+    if (isClosed())
+        return true;
+
+    std::size_t size = (KIND_SPSC == m_kind) ? m_spsc->size() : m_mpmc->size();
+    std::size_t capacity = (KIND_SPSC == m_kind) ? m_spsc->capacity() : m_mpmc->capacity();
+
+    return forSend ? (size < capacity) : (0 != size);
+}
+
+
+// A sender or receiver announces itself before it looks at the ring once
+// more, and the other side looks for waiters after it has changed the
+// ring, so one of the two always sees the other.
+bool Channel::park(Waiter* waiter, bool forSend)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_waiters.push_back(waiter);
+    m_totalWaiters.fetch_add(1);
+
+    if (isReady(forSend))
+    {
+        m_waiters.pop_back();
+        m_totalWaiters.fetch_sub(1);
+        return false;
+    }
+
+    return true;
+}
+
+
+void Channel::cancel(Waiter* waiter)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto i = std::find(m_waiters.begin(), m_waiters.end(), waiter);
+
+    if (m_waiters.end() != i)
+    {
+        m_waiters.erase(i);
+        m_totalWaiters.fetch_sub(1);
+    }
+}
+
+
+// Parks the calling thread.
+void Channel::block(bool forSend)
+{
+    struct Blocker : Waiter
+    {
+        Blocker() : isWoken(false) {}
+
+        void wake()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isWoken = true;
+            condition.notify_one();
+        }
+
+        std::mutex              mutex;
+        std::condition_variable condition;
+        bool                    isWoken;
+    };
+
+    Blocker blocker;
+
+    if (!park(&blocker, forSend))
+        return;
+
+    std::unique_lock<std::mutex> lock(blocker.mutex);
+
+    while (!blocker.isWoken)
+        blocker.condition.wait(lock);
+}
+
+
+void Channel::wakeAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (std::size_t i = 0; i < m_waiters.size(); i++)
+        m_waiters[i]->wake();
+
+    m_totalWaiters.fetch_sub(static_cast<int>(m_waiters.size()));
+    m_waiters.clear();
+}
+
+
+Channel& Channels::open(
+    const std::string& name,
+    std::size_t        capacity,
+    Channel::Kind      kind)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::unique_ptr<Channel>& channel = m_channels[name];
+
+    if (!channel)
+        channel.reset(new Channel(capacity, kind));
+
+    return *channel;
+}
+
+
+Channels& Channels::getDefault()
+{
+    static Channels channels;
+    return channels;
+}
@@ -0,0 +1,140 @@
+#ifndef CHANNEL_HPP_INCLUDED
+#define CHANNEL_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Ring.hpp"
+
+// Bounded queue of values between programs running on different threads,
+// used by SEND and RECEIVE. Sending and receiving are lock-free; only a
+// side that has to wait for room or for a value takes the lock, to park
+// until the other side wakes it. Strings are copied into the message, as
+// string values of a run must not be shared with another thread.
+class Channel
+{
+public:
+
+    enum Kind
+    {
+        KIND_SPSC,  // one sending and one receiving program at a time
+        KIND_MPMC
+    };
+
+    struct Message
+    {
+        enum Type
+        {
+            TYPE_REAL,
+            TYPE_INTEGER,
+            TYPE_STRING
+        };
+
+        Message() : type(TYPE_INTEGER), real(0), integer(0) {}
+
+        Type         type;
+        long double  real;
+        std::int64_t integer;
+        std::string  string;
+    };
+
+    // Something parked on a channel, woken once it may go on.
+    class Waiter
+    {
+    public:
+
+        virtual void wake() = 0;
+
+    protected:
+
+        ~Waiter() {}
+    };
+
+    explicit Channel(std::size_t capacity, Kind kind = KIND_MPMC);
+
+    // Move the message in or out; false when the channel is full, empty or,
+    // for trySend(), closed.
+    bool trySend(Message& message);
+    bool tryReceive(Message& message);
+
+    // Block until done; false once the channel is closed (and, for
+    // receive(), drained).
+    bool send(Message& message);
+    bool receive(Message& message);
+
+    // Wakes everybody; later sends fail, receives drain what is left.
+    void close();
+    bool isClosed() const { return m_isClosed.load(); }
+
+    // Parks the waiter until the channel may have room (forSend) or a
+    // value, or is closed. False, without parking, when it may already.
+    // A waiter is woken once and then forgotten; cancel() forgets it
+    // sooner.
+    bool park(Waiter* waiter, bool forSend);
+    void cancel(Waiter* waiter);
+
+private:
+
+    Channel(const Channel&);
+    Channel& operator =(const Channel&);
+
+    bool isReady(bool forSend) const;
+    void block(bool forSend);
+    void wakeAll();
+
+    // Called after every send and receive: wakes the parked waiters, if
+    // there are any, with one load on the fast path.
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (0 != m_totalWaiters.load(std::memory_order_relaxed))
+            wakeAll();
+    }
+
+    const Kind                         m_kind;
+    std::unique_ptr<SpscRing<Message>> m_spsc;
+    std::unique_ptr<MpmcRing<Message>> m_mpmc;
+
+    std::atomic<bool>    m_isClosed;
+    std::atomic<int>     m_totalWaiters;
+    std::mutex           m_mutex;
+    std::vector<Waiter*> m_waiters;
+};
+
+
+// Named channels shared by the programs of one host. A name is looked up
+// under a lock, so runs keep the channels they have used; channels live
+// as long as the registry.
+class Channels
+{
+public:
+
+    static const std::size_t DEFAULT_CAPACITY = 1024;
+
+    Channels() {}
+
+    // Creates the channel unless it exists already.
+    Channel& open(
+        const std::string& name,
+        std::size_t        capacity = DEFAULT_CAPACITY,
+        Channel::Kind      kind = Channel::KIND_MPMC);
+
+    // Registry used by executions that were given none.
+    static Channels& getDefault();
+
+private:
+
+    Channels(const Channels&);
+    Channels& operator =(const Channels&);
+
+    std::mutex                                      m_mutex;
+    std::map<std::string, std::unique_ptr<Channel>> m_channels;
+};
+
+#endif // CHANNEL_HPP_INCLUDED
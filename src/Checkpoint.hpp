@@ -0,0 +1,126 @@
+#ifndef CHECKPOINT_HPP_INCLUDED
+#define CHECKPOINT_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Binary encoding of checkpoints, see Execution::restore(). Integers are
+// little-endian whatever the machine; doubles go as their bits. Long
+// doubles are written as they are in memory, so a checkpoint can only be
+// read where long double has the same size.
+class CheckpointWriter
+{
+public:
+
+    explicit CheckpointWriter(std::ostream& out) : m_out(out) {}
+
+    void putInteger(std::uint64_t value)
+    {
+        char bytes[8];
+
+        for (int i = 0; i < 8; i++)
+            bytes[i] = static_cast<char>(value >> (8 * i));
+
+        m_out.write(bytes, sizeof(bytes));
+    }
+
+    void putDouble(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        putInteger(bits);
+    }
+
+    void putReal(long double value)
+    {
+        m_out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putString(const char* data, std::size_t size)
+    {
+        putInteger(size);
+        m_out.write(data, static_cast<std::streamsize>(size));
+    }
+
+    void putString(const std::string& value) { putString(value.data(), value.size()); }
+
+private:
+
+    CheckpointWriter(const CheckpointWriter&);
+    CheckpointWriter& operator =(const CheckpointWriter&);
+
+    std::ostream& m_out;
+};
+
+
+// Reads what CheckpointWriter wrote. Once anything is missing, every later
+// read fails as well and isGood() turns false.
+class CheckpointReader
+{
+public:
+
+    explicit CheckpointReader(std::istream& in) : m_in(in) {}
+
+    bool isGood() const { return !m_in.fail(); }
+
+    std::uint64_t getInteger()
+    {
+        unsigned char bytes[8] = {};
+        m_in.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+
+        std::uint64_t value = 0;
+
+        for (int i = 0; i < 8; i++)
+            value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+
+        return value;
+    }
+
+    double getDouble()
+    {
+        std::uint64_t bits = getInteger();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    long double getReal()
+    {
+        long double value = 0;
+        m_in.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+    // Reads in pieces, so that a damaged size fails at the end of the
+    // file rather than allocating all of it first.
+    bool getString(std::string& value)
+    {
+        std::uint64_t size = getInteger();
+        value.clear();
+
+        while (isGood() && (value.size() < size))
+        {
+            char chunk[4096];
+            std::size_t count = static_cast<std::size_t>(
+                std::min<std::uint64_t>(sizeof(chunk), size - value.size()));
+
+            m_in.read(chunk, static_cast<std::streamsize>(count));
+            value.append(chunk, count);
+        }
+
+        return isGood();
+    }
+
+private:
+
+    CheckpointReader(const CheckpointReader&);
+    CheckpointReader& operator =(const CheckpointReader&);
+
+    std::istream& m_in;
+};
+
+#endif // CHECKPOINT_HPP_INCLUDED
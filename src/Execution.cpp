@@ -0,0 +1,4074 @@
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stack>
+#include <tuple>
+#include "Checkpoint.hpp"
+#include "Execution.hpp"
+#include "MatKernels.hpp"
+#include "StringKernels.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4996)
+#endif
+
+// The entry of the name in a map of variables or arrays, added as zero,
+// empty or undimensioned if need be; only then is anything allocated, from
+// the map's own resource.
+template <typename Names>
+static typename Names::mapped_type& named(Names& names, std::string_view name)
+{
+    auto entry = names.find(name);
+
+    if (names.end() == entry)
+    {
+        entry = names.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(name),
+            std::forward_as_tuple()).first;
+    }
+
+    return entry->second;
+}
+
+
+// After restore(), the run goes on with what the checkpoint held.
+// Otherwise everything goes back to the arena, the stacks too, and the
+// arena is rewound.
+void Execution::reset()
+{
+    if (nullptr != m_recorder)
+        m_recorder->clear();
+
+    if (nullptr != m_replay)
+    {
+        m_replay->rewind();
+        m_replayIn.str(m_replay->getInput());
+        m_replayIn.clear();
+    }
+
+    if (m_isRestored)
+    {
+        m_isRestored = false;
+    }
+    else
+    {
+        m_realVars.clear();
+        m_intVars.clear();
+        m_strVars.clear();
+        m_realArrays.release();
+        m_intArrays.release();
+        m_strArrays.release();
+
+        seedRandom(m_isSeeded ? m_seed : drawSeed());
+
+        m_line = 0;
+        m_memoryBytes = 0;
+        m_arrayBytes = 0;
+
+        std::pmr::vector<std::size_t>(m_arena).swap(m_callStack);
+        std::pmr::vector<std::size_t>(m_arena).swap(m_elses);
+        m_operations.release();
+        m_types.release();
+        m_reals.release();
+        m_integers.release();
+        m_strings.release();
+        m_booleans.release();
+        m_calls.release();
+
+        m_arena->rewind();
+    }
+
+    resizeSlots();
+
+    m_isRandomSaved = false;
+    m_isSuspending = false;
+    m_countedStatements = 0;
+    m_countedEvaluations = 0;
+    m_recountedStatements = 0;
+    m_recountedEvaluations = 0;
+    m_trace.clear();
+    m_callResults.clear();
+    m_callNext = 0;
+
+    m_processes.clear();
+    m_nextProcess = 1;
+
+    m_governor.start();
+
+    m_openChannels.clear();
+    m_waitChannel = nullptr;
+}
+
+
+void Execution::resizeSlots()
+{
+    const std::size_t total = m_program.getTotalNames();
+
+    m_realArrays.bySlot.resize(total, nullptr);
+    m_intArrays.bySlot.resize(total, nullptr);
+    m_strArrays.bySlot.resize(total, nullptr);
+}
+
+
+bool Execution::run()
+{
+    SharedString::ResourceScope scope(m_arena);
+
+    reset();
+
+    m_isResumable = false;
+
+    bool isDone;
+
+    if (nullptr != m_profiler)
+        isDone = runProfiled();
+    else if (nullptr != m_sampler)
+        isDone = runSampled();
+    else if (nullptr != m_perfMap)
+        isDone = runMapped();
+    else if (nullptr != m_allocationProfiler)
+        isDone = runAllocationProfiled();
+    else
+        isDone = runPlain();
+
+    if (nullptr != m_metrics)
+        publish();
+
+    if (!isDone && !m_traceFile.empty())
+        writeTrace();
+
+    return isDone;
+}
+
+
+bool Execution::runPlain()
+{
+    std::size_t line = m_line;
+    
+    while (line < m_tokens.size())
+    {
+        if (m_governor.tick() && (Governor::VERDICT_STOP == govern(line)))
+        {
+            m_err << m_program.getSourceLine(line) << std::endl;
+            return false;
+        }
+
+        std::size_t k = line;
+        line = execute(line, 0, m_tokens[line].size());
+        trace(k, line);
+
+        if (SIZE_MAX == line)
+        {
+            m_err << m_program.getSourceLine(k) << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void Execution::start()
+{
+    SharedString::ResourceScope scope(m_arena);
+
+    reset();
+
+    m_isResumable = true;
+    m_status = STATUS_READY;
+    m_input.clear();
+    m_isInputClosed = false;
+}
+
+
+Execution::Status Execution::resume(std::size_t budget)
+{
+    if ((STATUS_FINISHED == m_status) || (STATUS_FAILED == m_status))
+        return m_status;
+
+    SharedString::ResourceScope scope(m_arena);
+
+    m_status = STATUS_READY;
+    m_governor.enter();
+
+    for (; (0 != budget) && (STATUS_READY == m_status); budget--)
+    {
+        if (m_line >= m_tokens.size())
+        {
+            m_status = STATUS_FINISHED;
+            break;
+        }
+
+        if (m_governor.tick())
+        {
+            Governor::Verdict verdict = govern(m_line);
+
+            if (Governor::VERDICT_YIELD == verdict)
+                break;
+
+            if (Governor::VERDICT_STOP == verdict)
+            {
+                m_err << m_program.getSourceLine(m_line) << std::endl;
+                m_status = STATUS_FAILED;
+                break;
+            }
+        }
+
+        m_countedStatements = 0;
+        m_countedEvaluations = 0;
+
+        std::size_t line = execute(m_line, 0, m_tokens[m_line].size());
+
+        if (SIZE_MAX == line)
+        {
+            if (!m_isSuspending)
+            {
+                trace(m_line, line);
+                m_err << m_program.getSourceLine(m_line) << std::endl;
+                m_status = STATUS_FAILED;
+                break;
+            }
+
+            // Leaves everything as it was when the statement started.
+            m_isSuspending = false;
+            m_callNext = 0;
+            m_recountedStatements = m_countedStatements;
+            m_recountedEvaluations = m_countedEvaluations;
+            m_printBuffer.str("");
+
+            if (m_isRandomSaved)
+                m_random = m_savedRandom, m_isRandomSaved = false;
+
+            break;
+        }
+
+        trace(m_line, line);
+        m_line = line;
+        m_isRandomSaved = false;
+        m_recountedStatements = 0;
+        m_recountedEvaluations = 0;
+
+        if (!m_callResults.empty())
+            m_callResults.clear(), m_callNext = 0;
+    }
+
+    m_governor.leave();
+
+    if (nullptr != m_metrics)
+        publish();
+
+    if ((STATUS_FAILED == m_status) && !m_traceFile.empty())
+        writeTrace();
+
+    return m_status;
+}
+
+
+// The temporaries "$" that expressions are evaluated into are no
+// variables of the program.
+void Execution::publish()
+{
+    m_metrics->setVariables(
+        m_realVars.size() - m_realVars.count("$"),
+        m_intVars.size() - m_intVars.count("$"),
+        m_strVars.size() - m_strVars.count("$"),
+        m_realArrays.byName.size() + m_intArrays.byName.size() + m_strArrays.byName.size(),
+        m_memoryBytes - std::min(m_memoryBytes, m_arrayBytes));
+}
+
+
+bool Execution::relocate(const Program::LineMap& lineMap)
+{
+    for (std::size_t i = 0; i < m_callStack.size(); i++)
+    {
+        if ((m_callStack[i] < lineMap.size()) && !lineMap[m_callStack[i]].isKept)
+        {
+            m_status = STATUS_FAILED;
+            return false;
+        }
+    }
+
+    // A return past the last line ends the run, as before.
+    for (std::size_t i = 0; i < m_callStack.size(); i++)
+    {
+        m_callStack[i] = (m_callStack[i] < lineMap.size())
+            ? lineMap[m_callStack[i]].line
+            : m_tokens.size();
+    }
+
+    resizeSlots();
+
+    // Literals are shared with the text of the lines they came from.
+    SharedString::ResourceScope scope(m_arena);
+
+    for (auto var = m_strVars.begin(); var != m_strVars.end(); ++var)
+        var->second.detach();
+
+    for (auto array = m_strArrays.byName.begin(); array != m_strArrays.byName.end(); ++array)
+    {
+        for (std::size_t i = 0; i < array->second.elements.size(); i++)
+            array->second.elements[i].detach();
+    }
+
+    if (m_line < lineMap.size())
+    {
+        // What a changed statement had done before it had to wait is
+        // forgotten, and the new one starts afresh.
+        if (!lineMap[m_line].isKept)
+        {
+            m_callResults.clear();
+            m_callNext = 0;
+            m_waitChannel = nullptr;
+
+            if ((STATUS_FINISHED != m_status) && (STATUS_FAILED != m_status))
+                m_status = STATUS_READY;
+        }
+
+        m_line = lineMap[m_line].line;
+    }
+    else
+    {
+        m_line = m_tokens.size();
+    }
+
+    return true;
+}
+
+
+// A checkpoint starts with the magic, then its version, the size of long
+// double, the hash of the program and the line to go on at. Then come the
+// state of the random number generator in its text form, the real,
+// integer and string variables by name, the real, integer and string
+// arrays by name with their extents and elements, and the GOSUB return
+// lines; every list starts with its size.
+static const char CHECKPOINT_MAGIC[8] = { 'C', 'I', 'T', 'B', 'A', 'S', 'I', 'C' };
+static const std::uint64_t CHECKPOINT_VERSION = 3;
+
+static void putElement(CheckpointWriter& writer, long double value)
+{
+    writer.putReal(value);
+}
+
+
+static void putElement(CheckpointWriter& writer, std::int64_t value)
+{
+    writer.putInteger(static_cast<std::uint64_t>(value));
+}
+
+
+static void putElement(CheckpointWriter& writer, const SharedString& value)
+{
+    writer.putString(value.data(), value.size());
+}
+
+
+// Element and string content bytes are added to bytes, as DIM and string
+// stores count them.
+static void getElement(CheckpointReader& reader, long double& value, std::size_t& bytes)
+{
+    value = reader.getReal();
+    bytes += sizeof(long double);
+}
+
+
+static void getElement(CheckpointReader& reader, std::int64_t& value, std::size_t& bytes)
+{
+    value = static_cast<std::int64_t>(reader.getInteger());
+    bytes += sizeof(std::int64_t);
+}
+
+
+static void getElement(CheckpointReader& reader, SharedString& value, std::size_t& bytes)
+{
+    std::string text;
+
+    if (reader.getString(text))
+        value = SharedString(text);
+
+    bytes += sizeof(SharedString) + text.size();
+}
+
+
+template <typename Arrays>
+static void putArrays(CheckpointWriter& writer, const Arrays& arrays)
+{
+    writer.putInteger(arrays.size());
+
+    for (auto array = arrays.begin(); array != arrays.end(); ++array)
+    {
+        writer.putString(array->first.data(), array->first.size());
+        writer.putInteger(array->second.extents.size());
+
+        for (std::size_t i = 0; i < array->second.extents.size(); i++)
+            writer.putInteger(array->second.extents[i]);
+
+        for (std::size_t i = 0; i < array->second.elements.size(); i++)
+            putElement(writer, array->second.elements[i]);
+    }
+}
+
+
+// Elements are read one at a time, so that damaged extents fail at the
+// end of the file rather than allocating all they claim first.
+template <typename Arrays>
+static bool getArrays(
+    CheckpointReader& reader,
+    std::size_t       maxDimensions,
+    Arrays&           arrays,
+    std::size_t&      bytes)
+{
+    std::uint64_t totalArrays = reader.getInteger();
+
+    for (std::uint64_t k = 0; (k < totalArrays) && reader.isGood(); k++)
+    {
+        std::string name;
+        reader.getString(name);
+
+        auto& array = named(arrays, name);
+        std::uint64_t totalExtents = reader.getInteger();
+
+        if ((0 == totalExtents) || (totalExtents > maxDimensions))
+            return false;
+
+        std::uint64_t totalElements = 1;
+
+        for (std::uint64_t i = 0; i < totalExtents; i++)
+        {
+            std::uint64_t extent = reader.getInteger();
+
+            if ((0 == extent) || (extent > SIZE_MAX / totalElements))
+                return false;
+
+            array.extents.push_back(static_cast<std::size_t>(extent));
+            totalElements *= extent;
+        }
+
+        for (std::uint64_t i = 0; (i < totalElements) && reader.isGood(); i++)
+        {
+            array.elements.push_back(typename decltype(array.elements)::value_type());
+            getElement(reader, array.elements.back(), bytes);
+        }
+    }
+
+    return reader.isGood();
+}
+
+
+// Written aside and then renamed over the old one, so that a crash while
+// writing leaves the previous checkpoint whole.
+bool Execution::checkpoint(std::size_t line, const std::string& fileName)
+{
+    if (fileName.empty())
+    {
+        m_err << "No checkpoint file!\n";
+        return false;
+    }
+
+    std::string temporary(fileName + ".tmp");
+
+    {
+        std::ofstream file(
+            temporary.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+        CheckpointWriter writer(file);
+
+        file.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        writer.putInteger(CHECKPOINT_VERSION);
+        writer.putInteger(sizeof(long double));
+        writer.putInteger(m_program.getHash());
+        writer.putInteger(line);
+
+        std::ostringstream random;
+        random << m_random;
+        writer.putString(random.str());
+
+        writer.putInteger(m_realVars.size());
+
+        for (auto var = m_realVars.begin(); var != m_realVars.end(); ++var)
+            writer.putString(var->first.data(), var->first.size()), writer.putReal(var->second);
+
+        writer.putInteger(m_intVars.size());
+
+        for (auto var = m_intVars.begin(); var != m_intVars.end(); ++var)
+            writer.putString(var->first.data(), var->first.size()), putElement(writer, var->second);
+
+        writer.putInteger(m_strVars.size());
+
+        for (auto var = m_strVars.begin(); var != m_strVars.end(); ++var)
+            writer.putString(var->first.data(), var->first.size()), putElement(writer, var->second);
+
+        putArrays(writer, m_realArrays.byName);
+        putArrays(writer, m_intArrays.byName);
+        putArrays(writer, m_strArrays.byName);
+
+        writer.putInteger(m_callStack.size());
+
+        for (std::size_t i = 0; i < m_callStack.size(); i++)
+            writer.putInteger(m_callStack[i]);
+
+        file.close();
+
+        if (file.fail())
+        {
+            std::remove(temporary.c_str());
+            m_err << "Cannot write checkpoint \"" << fileName << "\"!\n";
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(fileName.c_str());
+#endif
+
+    if (0 != std::rename(temporary.c_str(), fileName.c_str()))
+    {
+        std::remove(temporary.c_str());
+        m_err << "Cannot write checkpoint \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool Execution::restore(std::istream& file)
+{
+    char magic[sizeof(CHECKPOINT_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+
+    CheckpointReader reader(file);
+
+    std::uint64_t version = reader.getInteger();
+    std::uint64_t realSize = reader.getInteger();
+    std::uint64_t hash = reader.getInteger();
+    std::uint64_t line = reader.getInteger();
+
+    if (!reader.isGood() ||
+        (0 != std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic))) ||
+        (CHECKPOINT_VERSION != version))
+    {
+        m_err << "Bad checkpoint!\n";
+        return false;
+    }
+
+    if (sizeof(long double) != realSize)
+    {
+        m_err << "Checkpoint is from another platform!\n";
+        return false;
+    }
+
+    if (m_program.getHash() != hash)
+    {
+        m_err << "Checkpoint is of another program!\n";
+        return false;
+    }
+
+    // Read aside, so that a damaged checkpoint changes nothing.
+    SharedString::ResourceScope scope(m_arena);
+
+    Random random;
+    Names<long double>  realVars(m_arena);
+    Names<std::int64_t> intVars(m_arena);
+    Names<SharedString> strVars(m_arena);
+    Names<Array<long double>>  realArrays(m_arena);
+    Names<Array<std::int64_t>> intArrays(m_arena);
+    Names<Array<SharedString>> strArrays(m_arena);
+    std::pmr::vector<std::size_t> callStack(m_arena);
+    std::size_t bytes = 0;
+
+    std::string text;
+    reader.getString(text);
+
+    std::istringstream randomText(text);
+    randomText >> random;
+
+    std::uint64_t total = reader.getInteger();
+
+    for (std::uint64_t i = 0; (i < total) && reader.isGood(); i++)
+    {
+        reader.getString(text);
+        named(realVars, text) = reader.getReal();
+    }
+
+    total = reader.getInteger();
+
+    for (std::uint64_t i = 0; (i < total) && reader.isGood(); i++)
+    {
+        reader.getString(text);
+        named(intVars, text) = static_cast<std::int64_t>(reader.getInteger());
+    }
+
+    total = reader.getInteger();
+
+    for (std::uint64_t i = 0; (i < total) && reader.isGood(); i++)
+    {
+        std::string value;
+        reader.getString(text);
+        reader.getString(value);
+
+        named(strVars, text) = SharedString(value);
+        bytes += value.size();
+    }
+
+    bool isGood = !randomText.fail() &&
+        getArrays(reader, MAX_ARRAY_DIMENSIONS, realArrays, bytes) &&
+        getArrays(reader, MAX_ARRAY_DIMENSIONS, intArrays, bytes) &&
+        getArrays(reader, MAX_ARRAY_DIMENSIONS, strArrays, bytes) &&
+        (line <= m_tokens.size());
+
+    total = reader.getInteger();
+
+    for (std::uint64_t i = 0; (i < total) && isGood && reader.isGood(); i++)
+    {
+        std::uint64_t returnLine = reader.getInteger();
+        isGood = (returnLine <= m_tokens.size());
+        callStack.push_back(static_cast<std::size_t>(returnLine));
+    }
+
+    if (!isGood || !reader.isGood())
+    {
+        m_err << "Bad checkpoint!\n";
+        return false;
+    }
+
+    m_random = random;
+    m_realVars.swap(realVars);
+    m_intVars.swap(intVars);
+    m_strVars.swap(strVars);
+    m_realArrays.byName.swap(realArrays);
+    m_intArrays.byName.swap(intArrays);
+    m_strArrays.byName.swap(strArrays);
+    m_realArrays.bySlot.clear();
+    m_intArrays.bySlot.clear();
+    m_strArrays.bySlot.clear();
+    m_callStack.swap(callStack);
+    m_memoryBytes = bytes;
+    m_arrayBytes = 0;
+
+    for (auto array = m_realArrays.byName.begin(); array != m_realArrays.byName.end(); ++array)
+        m_arrayBytes += array->second.elements.size() * sizeof(long double);
+
+    for (auto array = m_intArrays.byName.begin(); array != m_intArrays.byName.end(); ++array)
+        m_arrayBytes += array->second.elements.size() * sizeof(std::int64_t);
+
+    for (auto array = m_strArrays.byName.begin(); array != m_strArrays.byName.end(); ++array)
+        m_arrayBytes += array->second.elements.size() * sizeof(SharedString);
+
+    m_line = static_cast<std::size_t>(line);
+    m_isRestored = true;
+
+    return true;
+}
+
+
+void Execution::completeCall()
+{
+    std::uint64_t start = (nullptr != m_metrics) ? Metrics::now() : 0;
+
+    m_callResults.push_back(performCall(m_callFunction, m_callCommand, m_callHandle));
+
+    if (nullptr != m_metrics)
+        m_metrics->recordLatency(Metrics::LATENCY_PROCESS, Metrics::now() - start);
+
+    if (nullptr != m_recorder)
+        m_recorder->putCall(m_callResults.back().status, m_callResults.back().output);
+}
+
+
+bool Execution::call(
+    Token::Value       function,
+    const std::string& command,
+    std::int64_t       handle,
+    CallResult&        result)
+{
+    if (m_callNext < m_callResults.size())
+    {
+        result = m_callResults[m_callNext++];
+        return true;
+    }
+
+    // A replay starts no process and never waits.
+    if (nullptr != m_replay)
+    {
+        if (!m_replay->getCall(result.status, result.output))
+        {
+            m_err << "Nothing left to replay!\n";
+            return false;
+        }
+
+        if (nullptr != m_recorder)
+            m_recorder->putCall(result.status, result.output);
+
+        if (m_isResumable)
+            m_callResults.push_back(result), m_callNext++;
+
+        return true;
+    }
+
+    if (((Token::FUNCTION_WAIT == function) ||
+            (Token::FUNCTION_WAIT_OUTPUT == function)) &&
+        (m_processes.end() == m_processes.find(handle)))
+    {
+        m_err << "Bad process handle!\n";
+        return false;
+    }
+
+    // SPAWN returns at once; in a resumable run everything else waits on
+    // the host's thread instead, see completeCall().
+    if (m_isResumable && (Token::FUNCTION_SPAWN != function))
+    {
+        m_callFunction = function;
+        m_callCommand = command;
+        m_callHandle = handle;
+        suspend(STATUS_WAITING_SHELL);
+        return false;
+    }
+
+    std::uint64_t start = (nullptr != m_metrics) ? Metrics::now() : 0;
+
+    result = performCall(function, command, handle);
+
+    if (nullptr != m_metrics)
+        m_metrics->recordLatency(Metrics::LATENCY_PROCESS, Metrics::now() - start);
+
+    if (nullptr != m_recorder)
+        m_recorder->putCall(result.status, result.output);
+
+    if (m_isResumable)
+        m_callResults.push_back(result), m_callNext++;
+
+    return true;
+}
+
+
+// Captured output loses its trailing line breaks, as in the shell's $( ).
+static void trimOutput(std::string& output)
+{
+    std::size_t size = output.size();
+
+    while ((0 < size) && (('\n' == output[size - 1]) || ('\r' == output[size - 1])))
+        size--;
+
+    output.resize(size);
+}
+
+
+Execution::CallResult Execution::performCall(
+    Token::Value       function,
+    const std::string& command,
+    std::int64_t       handle)
+{
+    CallResult result;
+    result.status = 0;
+
+    switch (function)
+    {
+    case Token::FUNCTION_SPAWN:
+        {
+            std::unique_ptr<Process> process(new Process());
+            process->start(command, Process::FLAG_SHELL | Process::FLAG_CAPTURE);
+
+            result.status = m_nextProcess;
+            m_processes[m_nextProcess++] = std::move(process);
+        }
+        return result;
+
+    case Token::FUNCTION_WAIT:
+    case Token::FUNCTION_WAIT_OUTPUT:
+        {
+            auto i = m_processes.find(handle);
+            result.status = i->second->wait();
+
+            if (Token::FUNCTION_WAIT == function)
+                m_processes.erase(i);
+            else
+                trimOutput(result.output = i->second->getOutput());
+        }
+        return result;
+    }
+
+    unsigned flags = 0;
+
+    if ((Token::FUNCTION_SHELL == function) ||
+        (Token::FUNCTION_SHELL_OUTPUT == function))
+        flags |= Process::FLAG_SHELL;
+
+    if ((Token::FUNCTION_EXEC_OUTPUT == function) ||
+        (Token::FUNCTION_SHELL_OUTPUT == function))
+        flags |= Process::FLAG_CAPTURE;
+    else
+        m_out.flush();  // what the child prints comes after ours
+
+    Process process;
+    process.start(command, flags);
+
+    result.status = process.wait();
+    result.output = process.getOutput();
+    trimOutput(result.output);
+    return result;
+}
+
+
+// Same loop as in run(), kept apart so that an unprofiled run does not pay
+// for the timestamps.
+bool Execution::runProfiled()
+{
+    m_profiler->reset(m_tokens.size());
+
+    std::size_t line = m_line;
+
+    while (line < m_tokens.size())
+    {
+        if (m_governor.tick() && (Governor::VERDICT_STOP == govern(line)))
+        {
+            m_profiler->finish(Profiler::now());
+            m_err << m_program.getSourceLine(line) << std::endl;
+            return false;
+        }
+
+        std::size_t k = line;
+        std::size_t depth = m_callStack.size();
+        std::uint64_t start = Profiler::now();
+
+        line = execute(line, 0, m_tokens[line].size());
+
+        m_profiler->record(k, line, start, Profiler::now(), depth, m_callStack.size());
+        trace(k, line);
+
+        if (SIZE_MAX == line)
+        {
+            m_profiler->finish(Profiler::now());
+            m_err << m_program.getSourceLine(k) << std::endl;
+            return false;
+        }
+    }
+
+    m_profiler->finish(Profiler::now());
+    return true;
+}
+
+
+// The sampling timer only raises a flag; ticks are charged to the line
+// that was running when they are noticed. GOSUB and RETURN lines are
+// charged to the shallower of the call stacks before and after them.
+bool Execution::runSampled()
+{
+    if (!m_sampler->start(m_err))
+        return false;
+
+    std::size_t line = m_line;
+
+    while (line < m_tokens.size())
+    {
+        if (m_governor.tick() && (Governor::VERDICT_STOP == govern(line)))
+        {
+            m_sampler->stop();
+            m_err << m_program.getSourceLine(line) << std::endl;
+            return false;
+        }
+
+        std::size_t k = line;
+        std::size_t depth = m_callStack.size();
+
+        line = execute(line, 0, m_tokens[line].size());
+        trace(k, line);
+
+        if (Sampler::pending())
+        {
+            m_sampler->record(
+                k, m_callStack.data(), std::min(depth, m_callStack.size()));
+        }
+
+        if (SIZE_MAX == line)
+        {
+            m_sampler->stop();
+            m_err << m_program.getSourceLine(k) << std::endl;
+            return false;
+        }
+    }
+
+    m_sampler->stop();
+    return true;
+}
+
+
+// Lines run through their stubs so that native profilers can tell them
+// apart; see PerfMap.
+bool Execution::runMapped()
+{
+    if (!m_perfMap->build(m_program, &Execution::executeLine, m_err))
+        return false;
+
+    std::size_t line = m_line;
+
+    while (line < m_tokens.size())
+    {
+        if (m_governor.tick() && (Governor::VERDICT_STOP == govern(line)))
+        {
+            m_err << m_program.getSourceLine(line) << std::endl;
+            return false;
+        }
+
+        std::size_t k = line;
+        line = m_perfMap->getEntry(line)(this, line);
+        trace(k, line);
+
+        if (SIZE_MAX == line)
+        {
+            m_err << m_program.getSourceLine(k) << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool Execution::runAllocationProfiled()
+{
+    m_allocationProfiler->reset(m_tokens.size());
+
+    std::size_t line = m_line;
+
+    while (line < m_tokens.size())
+    {
+        if (m_governor.tick() && (Governor::VERDICT_STOP == govern(line)))
+        {
+            m_err << m_program.getSourceLine(line) << std::endl;
+            return false;
+        }
+
+        std::size_t k = line;
+        AllocationProfiler::Count start = AllocationProfiler::now();
+
+        line = execute(line, 0, m_tokens[line].size());
+        trace(k, line);
+
+        if (!m_tokens[k].empty())
+        {
+            m_allocationProfiler->record(
+                k, m_tokens[k][0], start, AllocationProfiler::now());
+        }
+
+        if (SIZE_MAX == line)
+        {
+            m_err << m_program.getSourceLine(k) << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Reads through to another buffer and counts what is taken from it, and
+// copies it unless copy is nullptr. It keeps no buffer of its own, so
+// nothing is read ahead of the reader.
+class CountingBuffer : public std::streambuf
+{
+public:
+
+    CountingBuffer(std::streambuf* source, std::string* copy)
+        : m_source(source), m_copy(copy), m_count(0)
+    {
+    }
+
+    std::size_t getCount() const { return m_count; }
+
+protected:
+
+    virtual int_type underflow()
+    {
+        return m_source->sgetc();
+    }
+
+    virtual int_type uflow()
+    {
+        int_type c = m_source->sbumpc();
+
+        if (!traits_type::eq_int_type(traits_type::eof(), c))
+        {
+            m_count++;
+
+            if (nullptr != m_copy)
+                m_copy->push_back(traits_type::to_char_type(c));
+        }
+
+        return c;
+    }
+
+    virtual int_type pbackfail(int_type)
+    {
+        int_type c = m_source->sungetc();
+
+        if (!traits_type::eq_int_type(traits_type::eof(), c))
+        {
+            m_count--;
+
+            if ((nullptr != m_copy) && !m_copy->empty())
+                m_copy->erase(m_copy->size() - 1);
+        }
+
+        return c;
+    }
+
+private:
+
+    std::streambuf* m_source;
+    std::string*    m_copy;
+    std::size_t     m_count;
+};
+
+
+std::size_t Execution::executeLine(void* context, std::size_t line)
+{
+    Execution* self = static_cast<Execution*>(context);
+    return self->execute(line, 0, self->m_tokens[line].size());
+}
+
+
+std::size_t Execution::execute(
+    std::size_t line,
+    std::size_t begin,
+    std::size_t end)
+{
+    if (begin < m_tokens[line].size())
+    {
+        if ((nullptr != m_metrics) && (++m_countedStatements > m_recountedStatements))
+        {
+            if (Token::TYPE_KEYWORD == m_tokens[line][begin].getType())
+                m_metrics->countStatement(m_tokens[line][begin].getValue());
+            else
+                m_metrics->countAssignment();
+        }
+
+    restart:
+
+        switch(m_tokens[line][begin].getType())
+        {
+        case Token::TYPE_IDENTIFIER:
+            if ((end - begin >= 2) &&
+                (Token::PUNCTUATION_MARK_PARENTHESIS_LEFT ==
+                    m_tokens[line][begin + 1].getValue()))
+            {
+                if (!assignElement(line, begin, end))
+                    return SIZE_MAX;
+
+                break;
+            }
+
+            if (end - begin >= 3)
+            {
+                Token::Value value = m_tokens[line][begin].getValue();
+
+                OperandType operandType =
+                    Token::IDENTIFIER_REAL ==  value
+                        ? OPERAND_TYPE_REAL
+                        : Token::IDENTIFIER_INTEGER == value
+                            ? OPERAND_TYPE_INTEGER
+                            : OPERAND_TYPE_STRING;
+
+                value = m_tokens[line][begin + 1].getValue();
+                if (Token::OPERATOR_EQUAL != value)
+                {
+                    m_err << "Assignment operator expected!\n";
+                    return SIZE_MAX;
+                }
+
+                bool boolResult;
+
+                if (!evaluate(
+                    m_tokens[line].begin() + begin + 2, 
+                    m_tokens[line].begin() + end,
+                    boolResult,
+                    getName(m_tokens[line][begin]),
+                    operandType))
+                {
+                    return SIZE_MAX;
+                }
+
+                break;
+            }
+            m_err << "Incomplete assignment statement!\n";
+            return SIZE_MAX;
+
+        case Token::TYPE_KEYWORD:
+            switch (m_tokens[line][begin].getValue())
+            {
+            case Token::KEYWORD_LET:
+                if (++begin < end)
+                    goto restart;
+                m_err << "Incomplete LET statement!\n";
+                return SIZE_MAX;
+
+            case Token::KEYWORD_DIM:
+                if (!dimension(line, begin + 1, end))
+                    return SIZE_MAX;
+                break;
+
+            case Token::KEYWORD_MAT:
+                if (!matrix(line, begin + 1, end))
+                    return SIZE_MAX;
+                break;
+
+            case Token::KEYWORD_SEND:
+                if (!send(line, begin + 1, end))
+                    return SIZE_MAX;
+                break;
+
+            case Token::KEYWORD_RECEIVE:
+                if (!receive(line, begin + 1, end))
+                    return SIZE_MAX;
+                break;
+
+            case Token::KEYWORD_CHECKPOINT:
+                {
+                    std::string fileName(m_checkpointFile);
+
+                    if (begin + 1 < end)
+                    {
+                        bool boolResult;
+
+                        if (!evaluate(
+                            m_tokens[line].begin() + begin + 1,
+                            m_tokens[line].begin() + end,
+                            boolResult, "$", OPERAND_TYPE_STRING))
+                        {
+                            return SIZE_MAX;
+                        }
+
+                        fileName = m_strVars["$"].str();
+                    }
+
+                    // As with requested checkpoints, one that cannot be
+                    // written is reported and the run goes on.
+                    checkpoint(line + 1, fileName);
+                }
+                break;
+
+            case Token::KEYWORD_RANDOMIZE:
+                if (begin + 1 < end)
+                {
+                    bool boolResult;
+
+                    if (!evaluate(
+                        m_tokens[line].begin() + begin + 1,
+                        m_tokens[line].begin() + end,
+                        boolResult, "$", OPERAND_TYPE_INTEGER))
+                    {
+                        return SIZE_MAX;
+                    }
+
+                    seedRandom(static_cast<std::uint64_t>(m_intVars["$"]));
+                }
+                else
+                    seedRandom(drawSeed());
+                break;
+
+            case Token::KEYWORD_PRINT:
+                {
+                    // A resumable run may restart the statement halfway, so
+                    // it prints nothing until every expression is done.
+                    std::ostream& out = m_isResumable ? m_printBuffer : m_out;
+
+                    begin++;
+                    while (begin < end)
+                    {
+                        std::size_t i;
+
+                        for (i = begin; i < end; i++)
+                        {
+                            if (Token::PUNCTUATION_MARK_SEMICOLON ==
+                                m_tokens[line][i].getValue())
+                                break;
+                        }
+
+                        bool boolResult;
+
+                        if (!evaluate(
+                            m_tokens[line].begin() + begin,
+                            m_tokens[line].begin() + i,
+                            boolResult, "$", OPERAND_TYPE_STRING))
+                        {
+                            return SIZE_MAX;
+                        }
+
+                        const SharedString& text = m_strVars["$"];
+                        out << text << " ";
+
+                        if (nullptr != m_metrics)
+                            m_metrics->countOutput(text.size() + 1);
+
+                        begin = i + 1;
+                    }
+                    out << std::endl;
+
+                    if (nullptr != m_metrics)
+                        m_metrics->countOutput(1);
+
+                    if (m_isResumable)
+                    {
+                        m_out << m_printBuffer.str() << std::flush;
+                        m_printBuffer.str("");
+                    }
+                }
+                break;
+
+            case Token::KEYWORD_INPUT:
+                if (begin + 1 < end)
+                {
+                    // A resumable run reads the statement's values from one
+                    // whole line, waiting until it has been provided. A
+                    // replay reads the recorded text, also a line at a time
+                    // when resumable.
+                    std::istringstream lineIn;
+
+                    // With metrics or a recorder, a stream is read through
+                    // a counter.
+                    std::unique_ptr<CountingBuffer> counter;
+                    std::unique_ptr<std::istream>   countedIn;
+                    std::string                     taken;
+                    std::uint64_t                   start = 0;
+
+                    if (m_isResumable && (nullptr != m_replay))
+                    {
+                        std::string text;
+
+                        if (std::getline(m_replayIn, text) && !m_replayIn.eof())
+                            text.push_back('\n');
+
+                        lineIn.str(text);
+                    }
+                    else if (m_isResumable)
+                    {
+                        std::size_t n = m_input.find('\n');
+
+                        if (std::string::npos != n)
+                            n++;
+                        else if (m_isInputClosed)
+                            n = m_input.size();
+                        else
+                            return suspend(STATUS_WAITING_INPUT);
+
+                        lineIn.str(m_input.substr(0, n));
+
+                        if (nullptr != m_recorder)
+                            m_recorder->putInput(m_input.data(), n);
+
+                        m_input.erase(0, n);
+
+                        if (nullptr != m_metrics)
+                            m_metrics->countInput(n);
+                    }
+                    else if ((nullptr == m_replay) &&
+                        ((nullptr != m_metrics) || (nullptr != m_recorder)))
+                    {
+                        counter.reset(new CountingBuffer(
+                            m_in.rdbuf(), (nullptr != m_recorder) ? &taken : nullptr));
+                        countedIn.reset(new std::istream(counter.get()));
+                        countedIn->setstate(m_in.rdstate());
+                        countedIn->tie(m_in.tie());
+                        start = Metrics::now();
+                    }
+
+                    std::istream& in = m_isResumable
+                        ? lineIn
+                        : ((nullptr != m_replay)
+                            ? m_replayIn
+                            : (countedIn ? *countedIn : m_in));
+
+                    std::size_t id = begin + 1;
+
+                    while (id < end)
+                    {
+                        if (Token::LITERAL_STRING == m_tokens[line][id].getValue())
+                        {
+                            std::string prompt(m_tokens[line][id].getString());
+                            m_out << prompt << " ";
+
+                            if (nullptr != m_metrics)
+                                m_metrics->countOutput(prompt.size() + 1);
+                        }
+                        else if (Token::TYPE_IDENTIFIER == m_tokens[line][id].getType())
+                        {
+                            switch (m_tokens[line][id].getValue())
+                            {
+                            case Token::IDENTIFIER_REAL:
+                                in >> named(m_realVars,
+                                    getName(m_tokens[line][id]));
+                                break;
+
+                            case Token::IDENTIFIER_INTEGER:
+                                in >> named(m_intVars,
+                                    getName(m_tokens[line][id]));
+                                break;
+
+                            case Token::IDENTIFIER_STRING:
+                                {
+                                    std::string text;
+
+                                    if (id + 1 < end)
+                                        in >> text;
+                                    else
+                                        std::getline(in, text);
+
+                                    storeString(
+                                        named(m_strVars, getName(m_tokens[line][id])),
+                                        SharedString(text));
+                                }
+                                break;
+                            }
+                            if (in.fail())
+                            {
+                                std::string t;
+                                in.clear();
+                                in >> t;
+                                m_err << "[ " << t
+                                    << " ] inappropriate input value!\n";
+                            }
+                        }
+                        else
+                        {
+                            m_err << "Unsuitable INPUT parameter!\n";
+                            return SIZE_MAX;
+                        }
+
+                        id++;
+
+                        if ((id < end) && (Token::PUNCTUATION_MARK_COMMA ==
+                            m_tokens[line][id].getValue()))
+                        {
+                            if (++id < end)
+                                continue;
+
+                            m_err << "Extra comma on line!\n";
+                            return SIZE_MAX;
+                        }
+                    }
+
+                    if (countedIn)
+                    {
+                        m_in.setstate(countedIn->rdstate() & std::ios::eofbit);
+
+                        if (nullptr != m_metrics)
+                        {
+                            m_metrics->countInput(counter->getCount());
+                            m_metrics->recordLatency(
+                                Metrics::LATENCY_INPUT, Metrics::now() - start);
+                        }
+
+                        if (nullptr != m_recorder)
+                            m_recorder->putInput(taken.data(), taken.size());
+                    }
+
+                    if (1 != id - begin)
+                        break;
+                }
+                m_err << "Incomplete INPUT statement!\n";
+                return SIZE_MAX;
+
+            case Token::KEYWORD_GOTO:
+            case Token::KEYWORD_GOSUB:
+                if (2 != end - begin)
+                {
+                    m_err << "Bad jump!\n";
+                    return SIZE_MAX;
+                }
+                else
+                {
+                    // Line numbers are short enough for the string's own
+                    // buffer and labels come by name from the program, so
+                    // jumps allocate nothing.
+                    std::string number;
+                    const std::string* key = &number;
+
+                    switch (m_tokens[line][begin + 1].getValue())
+                    {
+                    case Token::LITERAL_INTEGER:
+                        number = std::to_string(m_tokens[line][begin + 1].getInteger());
+                        break;
+
+                    case Token::IDENTIFIER_LABEL:
+                        key = &getName(m_tokens[line][begin + 1]);
+                        break;
+
+                    default:
+                        m_err << "Bad jump label!\n";
+                        return SIZE_MAX;
+                    }
+
+                    std::size_t target = m_program.findLabel(*key);
+
+                    if (SIZE_MAX == target)
+                    {
+                        m_err << "Jump label \'" << *key
+                                  << "\' does not exist!\n";
+                        return SIZE_MAX;
+                    }
+
+                    if (Token::KEYWORD_GOSUB == m_tokens[line][begin].getValue())
+                    {
+                        if (0xFFFF < m_callStack.size())
+                        {
+                            m_err << "Call stack overflow!\n";
+                            return SIZE_MAX;
+                        }
+                        m_callStack.push_back(line + 1);
+
+                        if (nullptr != m_metrics)
+                            m_metrics->countCall(m_callStack.size());
+                    }
+
+                    if (nullptr != m_metrics)
+                        m_metrics->countJump();
+
+                    return target;
+                }
+
+            case Token::KEYWORD_RETURN:
+                if (!m_callStack.empty())
+                {
+                    auto result = m_callStack.back();
+                    m_callStack.pop_back();
+
+                    if (nullptr != m_metrics)
+                        m_metrics->countJump();
+
+                    return result;
+                }
+                m_err << "Call stack is empty!\n";
+                return SIZE_MAX;
+
+            case Token::KEYWORD_END:
+                return m_tokens.size();
+
+            case Token::KEYWORD_STOP:
+                return SIZE_MAX;
+
+            case Token::KEYWORD_IF:
+                {
+                    std::size_t beginCond = begin + 1;
+                    std::size_t endCond = beginCond;
+                    while (true)
+                    {
+                        if (endCond >= end)
+                        {
+                            m_err << "Incomplete IF statement!\n";
+                            return SIZE_MAX;
+                        }
+
+                        Token::Value value =
+                            m_tokens[line][endCond].getValue();
+                        
+                        if ((Token::KEYWORD_THEN  == value) ||
+                            (Token::KEYWORD_GOTO  == value) ||
+                            (Token::KEYWORD_GOSUB == value))
+                            break;
+
+                        endCond++;
+                    }
+
+                    m_elses.clear();
+                    for (std::size_t i = end - 1; i > begin; i--)
+                    {
+                        if (Token::KEYWORD_ELSE == m_tokens[line][i].getValue())
+                            m_elses.push_back(i);
+                        else if (Token::KEYWORD_IF == m_tokens[line][i].getValue())
+                            if (!m_elses.empty())
+                                m_elses.pop_back();
+                    }
+
+                    if (1 < m_elses.size())
+                    {
+                        m_err << "Extra ELSE statement on line!\n";
+                        return SIZE_MAX;
+                    }
+
+                    // The branches below may hold IFs of their own.
+                    const std::size_t elsePosition =
+                        m_elses.empty() ? SIZE_MAX : m_elses.back();
+
+                    bool boolResult;
+
+                    if (!evaluate(
+                        m_tokens[line].begin() + beginCond,
+                        m_tokens[line].begin() + endCond,
+                        boolResult))
+                    {
+                        return SIZE_MAX;
+                    }
+                    
+                    auto beginThen = Token::KEYWORD_THEN ==
+                        m_tokens[line][endCond].getValue()
+                            ? endCond + 1 : endCond;
+
+                    if (boolResult)
+                        return execute(line, beginThen, 
+                            SIZE_MAX == elsePosition ? end : elsePosition);
+                    else
+                        if (SIZE_MAX != elsePosition)
+                            return execute(line, elsePosition + 1, end);
+                }
+                break;
+
+            default:
+                m_err << "Improper keyword placement!\n";
+                return SIZE_MAX;
+            }
+            break;
+
+        default:
+            m_err << "Bad statement!\n";
+            return SIZE_MAX;
+        }
+    }
+
+    return line + 1;
+}
+
+
+bool Execution::dimension(
+    std::size_t line,
+    std::size_t begin,
+    std::size_t end)
+{
+    if (begin >= end)
+    {
+        m_err << "Incomplete DIM statement!\n";
+        return false;
+    }
+
+    while (begin < end)
+    {
+        const Token& id = m_tokens[line][begin];
+
+        if ((Token::TYPE_IDENTIFIER != id.getType()) ||
+            (begin + 1 >= end) ||
+            (Token::PUNCTUATION_MARK_PARENTHESIS_LEFT !=
+                m_tokens[line][begin + 1].getValue()))
+        {
+            m_err << "Bad DIM statement!\n";
+            return false;
+        }
+
+        std::int64_t subscripts[MAX_ARRAY_DIMENSIONS];
+        std::size_t  totalSubscripts;
+        std::size_t  close;
+
+        if (!evaluateSubscripts(
+            line, begin + 1, end, subscripts, totalSubscripts, close))
+        {
+            return false;
+        }
+
+        std::pmr::vector<std::size_t> extents(m_arena);
+        std::size_t totalElements = 1;
+
+        const std::size_t elementBytes =
+            (Token::IDENTIFIER_REAL == id.getValue()) ? sizeof(long double) :
+            (Token::IDENTIFIER_INTEGER == id.getValue()) ? sizeof(std::int64_t) :
+            sizeof(SharedString);
+
+        for (std::size_t i = 0; i < totalSubscripts; i++)
+        {
+            if ((subscripts[i] < 0) ||
+                (static_cast<std::uint64_t>(subscripts[i]) >=
+                    (SIZE_MAX / elementBytes) / totalElements))
+            {
+                m_err << "Bad array dimension!\n";
+                return false;
+            }
+
+            extents.push_back(static_cast<std::size_t>(subscripts[i]) + 1);
+            totalElements *= extents.back();
+        }
+
+        // Checked before anything changes, so that the array and the
+        // counters stay as they were.
+        bool isTaken =
+            (Token::IDENTIFIER_REAL == id.getValue()) ? isDimensioned(m_realArrays, id) :
+            (Token::IDENTIFIER_INTEGER == id.getValue()) ? isDimensioned(m_intArrays, id) :
+            isDimensioned(m_strArrays, id);
+
+        if (isTaken)
+        {
+            m_err << "Array \'" << id.getString()
+                      << "\' is already dimensioned!\n";
+            return false;
+        }
+
+        // Checked before allocating, as one DIM can ask for a lot.
+        std::size_t bytes = totalElements * elementBytes;
+
+        std::size_t limit = m_governor.getLimits().memoryBytes;
+
+        if ((0 != limit) && (bytes > limit - std::min(limit, getMemoryUsage())))
+        {
+            m_err << "Memory limit exceeded!\n";
+            return false;
+        }
+
+        m_memoryBytes += bytes;
+        m_arrayBytes += bytes;
+
+        switch (id.getValue())
+        {
+        case Token::IDENTIFIER_REAL:
+            {
+                auto& array = makeArray(m_realArrays, id);
+                array.extents.swap(extents);
+                array.elements.assign(totalElements, 0);
+            }
+            break;
+
+        case Token::IDENTIFIER_INTEGER:
+            {
+                auto& array = makeArray(m_intArrays, id);
+                array.extents.swap(extents);
+                array.elements.assign(totalElements, 0);
+            }
+            break;
+
+        default:
+            {
+                auto& array = makeArray(m_strArrays, id);
+                array.extents.swap(extents);
+                array.elements.assign(totalElements, SharedString());
+            }
+            break;
+        }
+
+        begin = close + 1;
+
+        if (begin < end)
+        {
+            if ((Token::PUNCTUATION_MARK_COMMA !=
+                    m_tokens[line][begin].getValue()) ||
+                (++begin >= end))
+            {
+                m_err << "Bad DIM statement!\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool Execution::assignElement(
+    std::size_t line,
+    std::size_t begin,
+    std::size_t end)
+{
+    const Token& id = m_tokens[line][begin];
+
+    std::int64_t subscripts[MAX_ARRAY_DIMENSIONS];
+    std::size_t  totalSubscripts;
+    std::size_t  close;
+
+    if (!evaluateSubscripts(
+        line, begin + 1, end, subscripts, totalSubscripts, close))
+    {
+        return false;
+    }
+
+    if ((close + 1 >= end) ||
+        (Token::OPERATOR_EQUAL != m_tokens[line][close + 1].getValue()))
+    {
+        m_err << "Assignment operator expected!\n";
+        return false;
+    }
+
+    if (close + 2 >= end)
+    {
+        m_err << "Incomplete assignment statement!\n";
+        return false;
+    }
+
+    bool boolResult;
+
+    switch (id.getValue())
+    {
+    case Token::IDENTIFIER_REAL:
+        {
+            long double* target =
+                element(m_realArrays, id, subscripts, totalSubscripts);
+
+            if ((nullptr == target) || !evaluate(
+                m_tokens[line].begin() + close + 2,
+                m_tokens[line].begin() + end,
+                boolResult, "$", OPERAND_TYPE_REAL))
+            {
+                return false;
+            }
+
+            *target = m_realVars["$"];
+        }
+        break;
+
+    case Token::IDENTIFIER_INTEGER:
+        {
+            std::int64_t* target =
+                element(m_intArrays, id, subscripts, totalSubscripts);
+
+            if ((nullptr == target) || !evaluate(
+                m_tokens[line].begin() + close + 2,
+                m_tokens[line].begin() + end,
+                boolResult, "$", OPERAND_TYPE_INTEGER))
+            {
+                return false;
+            }
+
+            *target = m_intVars["$"];
+        }
+        break;
+
+    default:
+        {
+            SharedString* target =
+                element(m_strArrays, id, subscripts, totalSubscripts);
+
+            if ((nullptr == target) || !evaluate(
+                m_tokens[line].begin() + close + 2,
+                m_tokens[line].begin() + end,
+                boolResult, "$", OPERAND_TYPE_STRING))
+            {
+                return false;
+            }
+
+            storeString(*target, SharedString(m_strVars["$"]));
+        }
+        break;
+    }
+
+    return true;
+}
+
+
+bool Execution::evaluateSubscripts(
+    std::size_t   line,
+    std::size_t   begin,
+    std::size_t   end,
+    std::int64_t* subscripts,
+    std::size_t&  totalSubscripts,
+    std::size_t&  close)
+{
+    assert(Token::PUNCTUATION_MARK_PARENTHESIS_LEFT ==
+        m_tokens[line][begin].getValue());
+
+    std::size_t depth = 0;
+    std::size_t first = begin + 1;
+
+    totalSubscripts = 0;
+
+    for (std::size_t i = first; i < end; i++)
+    {
+        Token::Value value = m_tokens[line][i].getValue();
+
+        if (Token::PUNCTUATION_MARK_PARENTHESIS_LEFT == value)
+        {
+            depth++;
+        }
+        else if ((0 != depth) &&
+                 (Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT == value))
+        {
+            depth--;
+        }
+        else if ((0 == depth) &&
+                 ((Token::PUNCTUATION_MARK_COMMA             == value) ||
+                  (Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT == value)))
+        {
+            if (MAX_ARRAY_DIMENSIONS == totalSubscripts)
+            {
+                m_err << "Too many subscripts!\n";
+                return false;
+            }
+
+            bool boolResult;
+
+            if (!evaluate(
+                m_tokens[line].begin() + first,
+                m_tokens[line].begin() + i,
+                boolResult, "$", OPERAND_TYPE_INTEGER))
+            {
+                return false;
+            }
+
+            subscripts[totalSubscripts++] = m_intVars["$"];
+
+            if (Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT == value)
+            {
+                close = i;
+                return true;
+            }
+
+            first = i + 1;
+        }
+    }
+
+    m_err << "Unmatched opening parenthesis!\n";
+    return false;
+}
+
+
+// Evaluates the channel name in [begin, end).
+Channel* Execution::findChannel(
+    std::size_t line,
+    std::size_t begin,
+    std::size_t end)
+{
+    bool boolResult;
+
+    if (!evaluate(
+        m_tokens[line].begin() + begin,
+        m_tokens[line].begin() + end,
+        boolResult, "$", OPERAND_TYPE_STRING))
+    {
+        return nullptr;
+    }
+
+    std::string name(m_strVars["$"].str());
+
+    Channel*& channel = m_openChannels[name];
+
+    if (nullptr == channel)
+    {
+        Channels& channels =
+            (nullptr != m_channels) ? *m_channels : Channels::getDefault();
+
+        channel = &channels.open(name);
+    }
+
+    return channel;
+}
+
+
+// SEND name, value
+bool Execution::send(std::size_t line, std::size_t begin, std::size_t end)
+{
+    std::size_t comma = begin;
+    std::size_t depth = 0;
+
+    for (; comma < end; comma++)
+    {
+        Token::Value value = m_tokens[line][comma].getValue();
+
+        if (Token::PUNCTUATION_MARK_PARENTHESIS_LEFT == value)
+            depth++;
+        else if (Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT == value)
+            depth--;
+        else if ((Token::PUNCTUATION_MARK_COMMA == value) && (0 == depth))
+            break;
+    }
+
+    if ((comma == begin) || (comma + 1 >= end))
+    {
+        m_err << "Bad SEND statement!\n";
+        return false;
+    }
+
+    Channel* channel = findChannel(line, begin, comma);
+
+    if (nullptr == channel)
+        return false;
+
+    bool boolResult;
+    OperandType type;
+
+    if (!evaluate(
+        m_tokens[line].begin() + comma + 1,
+        m_tokens[line].begin() + end,
+        boolResult, "$", OPERAND_TYPE_STRING, &type))
+    {
+        return false;
+    }
+
+    Channel::Message message;
+
+    switch (type)
+    {
+    case OPERAND_TYPE_REAL:
+        message.type = Channel::Message::TYPE_REAL;
+        message.real = m_realVars["$"];
+        break;
+
+    case OPERAND_TYPE_INTEGER:
+        message.type = Channel::Message::TYPE_INTEGER;
+        message.integer = m_intVars["$"];
+        break;
+
+    case OPERAND_TYPE_STRING:
+        message.type = Channel::Message::TYPE_STRING;
+        message.string = m_strVars["$"].str();
+        break;
+
+    default:
+        m_err << "Type mismatch!\n";
+        return false;
+    }
+
+    bool isSent;
+
+    if (m_isResumable)
+    {
+        isSent = channel->trySend(message);
+    }
+    else
+    {
+        std::uint64_t start = (nullptr != m_metrics) ? Metrics::now() : 0;
+
+        isSent = channel->send(message);
+
+        if (nullptr != m_metrics)
+            m_metrics->recordLatency(Metrics::LATENCY_CHANNEL, Metrics::now() - start);
+    }
+
+    if (isSent)
+        return true;
+
+    if (channel->isClosed())
+    {
+        m_err << "Channel is closed!\n";
+        return false;
+    }
+
+    m_waitChannel = channel;
+    m_isWaitingToSend = true;
+    suspend(STATUS_WAITING_CHANNEL);
+    return false;
+}
+
+
+// RECEIVE name, variable
+bool Execution::receive(std::size_t line, std::size_t begin, std::size_t end)
+{
+    if ((end - begin < 3) ||
+        (Token::PUNCTUATION_MARK_COMMA != m_tokens[line][end - 2].getValue()) ||
+        (Token::TYPE_IDENTIFIER != m_tokens[line][end - 1].getType()))
+    {
+        m_err << "Bad RECEIVE statement!\n";
+        return false;
+    }
+
+    Channel* channel = findChannel(line, begin, end - 2);
+
+    if (nullptr == channel)
+        return false;
+
+    Channel::Message message;
+
+    bool isReceived;
+
+    if (m_isResumable)
+    {
+        isReceived = channel->tryReceive(message);
+    }
+    else
+    {
+        std::uint64_t start = (nullptr != m_metrics) ? Metrics::now() : 0;
+
+        isReceived = channel->receive(message);
+
+        if (nullptr != m_metrics)
+            m_metrics->recordLatency(Metrics::LATENCY_CHANNEL, Metrics::now() - start);
+    }
+
+    // A closed channel may still hold what was sent before.
+    if (!isReceived && m_isResumable && !channel->isClosed())
+    {
+        m_waitChannel = channel;
+        m_isWaitingToSend = false;
+        suspend(STATUS_WAITING_CHANNEL);
+        return false;
+    }
+
+    if (!isReceived && !channel->tryReceive(message))
+    {
+        m_err << "Channel is closed!\n";
+        return false;
+    }
+
+    const Token& id = m_tokens[line][end - 1];
+
+    if ((Token::IDENTIFIER_STRING == id.getValue()) !=
+        (Channel::Message::TYPE_STRING == message.type))
+    {
+        m_err << "Type mismatch!\n";
+        return false;
+    }
+
+    switch (id.getValue())
+    {
+    case Token::IDENTIFIER_REAL:
+        named(m_realVars, getName(id)) =
+            (Channel::Message::TYPE_REAL == message.type)
+                ? message.real
+                : static_cast<long double>(message.integer);
+        break;
+
+    case Token::IDENTIFIER_INTEGER:
+        named(m_intVars, getName(id)) =
+            (Channel::Message::TYPE_INTEGER == message.type)
+                ? message.integer
+                : static_cast<std::int64_t>(message.real);
+        break;
+
+    default:
+        storeString(named(m_strVars, getName(id)), SharedString(message.string));
+        break;
+    }
+
+    return true;
+}
+
+
+// RND n: uniform over 0 to n, both included, whatever the sign of n.
+static std::int64_t drawInteger(Random& random, std::int64_t n)
+{
+    if (n >= 0)
+        return static_cast<std::int64_t>(random.below(static_cast<std::uint64_t>(n) + 1));
+
+    return static_cast<std::int64_t>(
+        0 - random.below(0 - static_cast<std::uint64_t>(n) + 1));
+}
+
+
+// VAL: the number text starts with, as std::stold reads it; false when
+// it starts with none or the number is out of range.
+static bool parseReal(const std::string& text, long double& value)
+{
+    const char* begin = text.c_str();
+    char* end = nullptr;
+
+    errno = 0;
+    value = std::strtold(begin, &end);
+
+    return (end != begin) && (ERANGE != errno);
+}
+
+
+bool Execution::matrix(
+    std::size_t line,
+    std::size_t begin,
+    std::size_t end)
+{
+    static const char BAD_MAT_STATEMENT[] = "Bad MAT statement!\n";
+    static const char TYPE_MISMATCH[] = "Type mismatch!\n";
+
+    const VectorOfTokens& tokens = m_tokens[line];
+
+    if ((end - begin < 3) ||
+        (Token::TYPE_IDENTIFIER != tokens[begin].getType()) ||
+        (Token::OPERATOR_EQUAL  != tokens[begin + 1].getValue()))
+    {
+        m_err << BAD_MAT_STATEMENT;
+        return false;
+    }
+
+    const Token& target = tokens[begin];
+    const Token* a = nullptr;
+    const Token* b = nullptr;
+    std::size_t  first = begin + 2;
+    MatOperation operation;
+
+    auto isArray = [&](std::size_t i) -> bool
+        {
+            return (i < end) &&
+                (Token::IDENTIFIER_REAL    == tokens[i].getValue() ||
+                 Token::IDENTIFIER_INTEGER == tokens[i].getValue());
+        };
+
+    auto isValue = [&](std::size_t i, Token::Value value) -> bool
+        {
+            return (i < end) && (value == tokens[i].getValue());
+        };
+
+    // MAT X = SUM(A), MIN(A), MAX(A) or DOT(A, B) reduce into a scalar.
+    if ((Token::IDENTIFIER_REAL == tokens[first].getValue()) &&
+        isValue(first + 1, Token::PUNCTUATION_MARK_PARENTHESIS_LEFT))
+    {
+        const std::string& name(getName(tokens[first]));
+
+        if ("SUM" == name)
+            operation = MAT_SUM;
+        else if ("MIN" == name)
+            operation = MAT_MIN;
+        else if ("MAX" == name)
+            operation = MAT_MAX;
+        else if ("DOT" == name)
+            operation = MAT_DOT;
+        else
+        {
+            m_err << BAD_MAT_STATEMENT;
+            return false;
+        }
+
+        std::size_t close = first + 3;
+
+        if (MAT_DOT == operation)
+        {
+            if (!isValue(first + 3, Token::PUNCTUATION_MARK_COMMA) ||
+                !isArray(first + 4))
+            {
+                m_err << BAD_MAT_STATEMENT;
+                return false;
+            }
+
+            b = &tokens[first + 4];
+            close = first + 5;
+        }
+
+        if (!isArray(first + 2) ||
+            !isValue(close, Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT) ||
+            (close + 1 != end))
+        {
+            m_err << BAD_MAT_STATEMENT;
+            return false;
+        }
+
+        a = &tokens[first + 2];
+
+        if ((nullptr != b) && (b->getValue() != a->getValue()))
+        {
+            m_err << TYPE_MISMATCH;
+            return false;
+        }
+
+        if (Token::IDENTIFIER_STRING == target.getValue())
+        {
+            m_err << TYPE_MISMATCH;
+            return false;
+        }
+
+        long double result;
+
+        if (Token::IDENTIFIER_REAL == a->getValue())
+        {
+            if (!matrixReduce(m_realArrays, operation, *a, b, result))
+                return false;
+        }
+        else
+        {
+            std::int64_t value;
+
+            if (!matrixReduce(m_intArrays, operation, *a, b, value))
+                return false;
+
+            if (Token::IDENTIFIER_INTEGER == target.getValue())
+            {
+                named(m_intVars, getName(target)) = value;
+                return true;
+            }
+
+            result = static_cast<long double>(value);
+        }
+
+        if (Token::IDENTIFIER_INTEGER == target.getValue())
+            named(m_intVars, getName(target)) = static_cast<std::int64_t>(result);
+        else
+            named(m_realVars, getName(target)) = result;
+
+        return true;
+    }
+
+    // MAT A = RND(n) sets every element of A as A(i) = RND(n) would, in
+    // one pass over the array.
+    if (Token::FUNCTION_RND == tokens[first].getValue())
+    {
+        if (first + 1 == end)
+        {
+            m_err << BAD_MAT_STATEMENT;
+            return false;
+        }
+
+        if (!isArray(begin))
+        {
+            m_err << TYPE_MISMATCH;
+            return false;
+        }
+
+        bool boolResult;
+
+        if (Token::IDENTIFIER_REAL == target.getValue())
+        {
+            Array<long double>* x = findArray(m_realArrays, target);
+
+            if ((nullptr == x) || !evaluate(
+                m_tokens[line].begin() + first + 1,
+                m_tokens[line].begin() + end,
+                boolResult, "$", OPERAND_TYPE_REAL))
+            {
+                return false;
+            }
+
+            random().fill(x->elements.data(), x->elements.size(), m_realVars["$"]);
+            return true;
+        }
+
+        Array<std::int64_t>* x = findArray(m_intArrays, target);
+
+        if ((nullptr == x) || !evaluate(
+            m_tokens[line].begin() + first + 1,
+            m_tokens[line].begin() + end,
+            boolResult, "$", OPERAND_TYPE_INTEGER))
+        {
+            return false;
+        }
+
+        std::int64_t n = m_intVars["$"];
+
+        if (n >= 0)
+        {
+            random().fill(x->elements.data(), x->elements.size(),
+                static_cast<std::uint64_t>(n) + 1);
+        }
+        else
+        {
+            random().fill(x->elements.data(), x->elements.size(),
+                0 - static_cast<std::uint64_t>(n) + 1);
+
+            for (std::size_t i = 0; i < x->elements.size(); i++)
+            {
+                x->elements[i] = static_cast<std::int64_t>(
+                    0 - static_cast<std::uint64_t>(x->elements[i]));
+            }
+        }
+
+        return true;
+    }
+
+    std::size_t close = first;
+
+    if (Token::PUNCTUATION_MARK_PARENTHESIS_LEFT == tokens[first].getValue())
+    {
+        // MAT C = (k) * A
+        std::size_t depth = 0;
+
+        for (close = first; close < end; close++)
+        {
+            Token::Value value = tokens[close].getValue();
+
+            if (Token::PUNCTUATION_MARK_PARENTHESIS_LEFT == value)
+                depth++;
+            else if ((Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT == value) &&
+                     (0 == --depth))
+                break;
+        }
+
+        if (!isValue(close + 1, Token::OPERATOR_MULTIPLY) ||
+            !isArray(close + 2) || (close + 3 != end))
+        {
+            m_err << BAD_MAT_STATEMENT;
+            return false;
+        }
+
+        operation = MAT_SCALE;
+        a = &tokens[close + 2];
+    }
+    else if (isArray(first) && (first + 1 == end))
+    {
+        operation = MAT_COPY;
+        a = &tokens[first];
+    }
+    else if (isArray(first) && isArray(first + 2) && (first + 3 == end))
+    {
+        switch (tokens[first + 1].getValue())
+        {
+        case Token::OPERATOR_ADD:
+            operation = MAT_ADD;
+            break;
+
+        case Token::OPERATOR_SUBTRACT:
+            operation = MAT_SUBTRACT;
+            break;
+
+        case Token::OPERATOR_MULTIPLY:
+            operation = MAT_MULTIPLY;
+            break;
+
+        default:
+            m_err << BAD_MAT_STATEMENT;
+            return false;
+        }
+
+        a = &tokens[first];
+        b = &tokens[first + 2];
+    }
+    else
+    {
+        m_err << BAD_MAT_STATEMENT;
+        return false;
+    }
+
+    if ((target.getValue() != a->getValue()) ||
+        ((nullptr != b) && (b->getValue() != a->getValue())))
+    {
+        m_err << TYPE_MISMATCH;
+        return false;
+    }
+
+    bool boolResult;
+
+    if (Token::IDENTIFIER_REAL == a->getValue())
+    {
+        long double factor = 1;
+
+        if (MAT_SCALE == operation)
+        {
+            if (!evaluate(
+                m_tokens[line].begin() + first + 1,
+                m_tokens[line].begin() + close,
+                boolResult, "$", OPERAND_TYPE_REAL))
+            {
+                return false;
+            }
+
+            factor = m_realVars["$"];
+        }
+
+        return matrixAssign(m_realArrays, operation, target, *a, b, factor);
+    }
+
+    std::int64_t factor = 1;
+
+    if (MAT_SCALE == operation)
+    {
+        if (!evaluate(
+            m_tokens[line].begin() + first + 1,
+            m_tokens[line].begin() + close,
+            boolResult, "$", OPERAND_TYPE_INTEGER))
+        {
+            return false;
+        }
+
+        factor = m_intVars["$"];
+    }
+
+    return matrixAssign(m_intArrays, operation, target, *a, b, factor);
+}
+
+
+template <typename T>
+bool Execution::matrixAssign(
+    Arrays<T>&   arrays,
+    MatOperation operation,
+    const Token& target,
+    const Token& a,
+    const Token* b,
+    T            factor)
+{
+    Array<T>* x = findArray(arrays, a);
+    Array<T>* y = nullptr;
+
+    if ((nullptr == x) ||
+        ((nullptr != b) && (nullptr == (y = findArray(arrays, *b)))))
+    {
+        return false;
+    }
+
+    std::pmr::vector<std::size_t> extents(x->extents, m_arena);
+
+    switch (operation)
+    {
+    case MAT_ADD:
+    case MAT_SUBTRACT:
+        if (x->extents != y->extents)
+        {
+            m_err << "Array shapes do not match!\n";
+            return false;
+        }
+        break;
+
+    case MAT_MULTIPLY:
+        if ((2 != x->extents.size()) ||
+            (y->extents.size() > 2) ||
+            (x->extents[1] != y->extents[0]))
+        {
+            m_err << "Array shapes do not match!\n";
+            return false;
+        }
+
+        extents.pop_back();
+        if (2 == y->extents.size())
+            extents.push_back(y->extents[1]);
+        break;
+    }
+
+    std::size_t count = 1;
+
+    for (std::size_t i = 0; i < extents.size(); i++)
+    {
+        if (extents[i] > (SIZE_MAX / sizeof(T)) / count)
+        {
+            m_err << "Bad array dimension!\n";
+            return false;
+        }
+
+        count *= extents[i];
+    }
+
+    // MAT may also create the target or give it a new shape. Growing it
+    // is charged and refused as DIM would, before allocating.
+    Array<T>& c = makeArray(arrays, target);
+
+    const std::size_t oldBytes = c.elements.size() * sizeof(T);
+    const std::size_t newBytes = count * sizeof(T);
+    const std::size_t limit = m_governor.getLimits().memoryBytes;
+
+    if ((0 != limit) && (newBytes > oldBytes) &&
+        (newBytes - oldBytes > limit - std::min(limit, getMemoryUsage())))
+    {
+        m_err << "Memory limit exceeded!\n";
+        return false;
+    }
+
+    // A matrix product cannot overwrite its own operands while it runs.
+    const bool inPlace = (c.elements.size() == count) &&
+        ((MAT_MULTIPLY != operation) || ((&c != x) && (&c != y)));
+
+    std::pmr::vector<T> scratch(m_arena);
+
+    if (!inPlace)
+        scratch.resize(count);
+
+    T* out = inPlace ? c.elements.data() : scratch.data();
+
+    switch (operation)
+    {
+    case MAT_COPY:
+        if (out != x->elements.data())
+            std::copy(x->elements.begin(), x->elements.end(), out);
+        break;
+
+    case MAT_ADD:
+        MatKernels::add(out, x->elements.data(), y->elements.data(), count);
+        break;
+
+    case MAT_SUBTRACT:
+        MatKernels::subtract(out, x->elements.data(), y->elements.data(), count);
+        break;
+
+    case MAT_SCALE:
+        MatKernels::scale(out, x->elements.data(), factor, count);
+        break;
+
+    case MAT_MULTIPLY:
+        MatKernels::multiply(out, x->elements.data(), y->elements.data(),
+            x->extents[0], x->extents[1],
+            (2 == y->extents.size()) ? y->extents[1] : 1);
+        break;
+    }
+
+    if (!inPlace)
+        c.elements.swap(scratch);
+
+    c.extents.swap(extents);
+
+    m_memoryBytes = m_memoryBytes - oldBytes + newBytes;
+    m_arrayBytes = m_arrayBytes - oldBytes + newBytes;
+    return true;
+}
+
+
+template <typename T>
+bool Execution::matrixReduce(
+    Arrays<T>&   arrays,
+    MatOperation operation,
+    const Token& a,
+    const Token* b,
+    T&           result)
+{
+    Array<T>* x = findArray(arrays, a);
+    Array<T>* y = nullptr;
+
+    if ((nullptr == x) ||
+        ((nullptr != b) && (nullptr == (y = findArray(arrays, *b)))))
+    {
+        return false;
+    }
+
+    const std::size_t count = x->elements.size();
+
+    switch (operation)
+    {
+    case MAT_DOT:
+        if (y->elements.size() != count)
+        {
+            m_err << "Array shapes do not match!\n";
+            return false;
+        }
+        result = MatKernels::dot(x->elements.data(), y->elements.data(), count);
+        break;
+
+    case MAT_SUM:
+        result = MatKernels::sum(x->elements.data(), count);
+        break;
+
+    case MAT_MIN:
+        result = MatKernels::min(x->elements.data(), count);
+        break;
+
+    default:
+        result = MatKernels::max(x->elements.data(), count);
+        break;
+    }
+
+    return true;
+}
+
+
+template <typename T>
+Execution::Array<T>& Execution::makeArray(Arrays<T>& arrays, const Token& id)
+{
+    Array<T>*& slot = arrays.bySlot[id.getSlot()];
+
+    if (nullptr == slot)
+        slot = &named(arrays.byName, getName(id));
+
+    return *slot;
+}
+
+
+template <typename T>
+Execution::Array<T>* Execution::findArray(Arrays<T>& arrays, const Token& id)
+{
+    Array<T>*& slot = arrays.bySlot[id.getSlot()];
+
+    if (nullptr != slot)
+        return slot;
+
+    auto array = arrays.byName.find(std::string_view(getName(id)));
+
+    if (arrays.byName.end() == array)
+    {
+        m_err << "Array \'" << id.getString()
+                  << "\' is not dimensioned!\n";
+        return nullptr;
+    }
+
+    slot = &array->second;
+    return slot;
+}
+
+
+template <typename T>
+bool Execution::isDimensioned(Arrays<T>& arrays, const Token& id)
+{
+    const Array<T>* array = arrays.bySlot[id.getSlot()];
+
+    if (nullptr == array)
+    {
+        auto found = arrays.byName.find(std::string_view(getName(id)));
+
+        if (arrays.byName.end() != found)
+            array = &found->second;
+    }
+
+    return (nullptr != array) && !array->extents.empty();
+}
+
+
+// Only the first reference to an array looks it up by name.
+template <typename T>
+T* Execution::element(
+    Arrays<T>&          arrays,
+    const Token&        id,
+    const std::int64_t* subscripts,
+    std::size_t         totalSubscripts)
+{
+    Array<T>* array = arrays.bySlot[id.getSlot()];
+
+    if ((nullptr == array) && (nullptr == (array = findArray(arrays, id))))
+        return nullptr;
+
+    const std::pmr::vector<std::size_t>& extents = array->extents;
+
+    if (extents.size() != totalSubscripts)
+    {
+        m_err << "Wrong number of subscripts!\n";
+        return nullptr;
+    }
+
+    std::size_t offset = 0;
+
+    for (std::size_t i = 0; i < totalSubscripts; i++)
+    {
+#if !defined(CITBASIC_UNCHECKED_ARRAYS)
+        if ((subscripts[i] < 0) ||
+            (static_cast<std::uint64_t>(subscripts[i]) >= extents[i]))
+        {
+            m_err << "Subscript out of range!\n";
+            return nullptr;
+        }
+#endif
+        offset = offset * extents[i] + static_cast<std::size_t>(subscripts[i]);
+    }
+
+    return &array->elements[offset];
+}
+
+
+bool Execution::evaluate(
+    VectorOfTokens::const_iterator begin,
+    VectorOfTokens::const_iterator end,
+    bool&                          boolResult,
+    std::string_view               varResult,
+    const OperandType              varType,
+    OperandType*                   resultType)
+{
+    static const char TYPE_MISMATCH[] = "Type mismatch!\n";
+    static const char DIVISION_BY_ZERO[] = "Division by zero!\n";
+    static const char BAD_EXPRESSION[]="Bad expression!\n";
+    static const char UNEXPECTED_PUNCTUATION_MARK[] =
+        "Unexpected punctuation mark!\n";
+    static const char WRONG_NUMBER_OF_ARGUMENTS[] =
+        "Wrong number of arguments!\n";
+
+    if ((nullptr != m_metrics) && (++m_countedEvaluations > m_recountedEvaluations))
+        m_metrics->countEvaluation();
+
+    // Nothing that evaluate() calls evaluates again, so the stacks can be
+    // shared; whatever a failed evaluation left on them goes here.
+    Stack<Operation>&    operations = m_operations;
+    Stack<OperandType>&  types      = m_types;
+    Stack<long double>&  reals      = m_reals;
+    Stack<std::int64_t>& integers   = m_integers;
+    Stack<SharedString>& strings    = m_strings;
+    Stack<char>&         booleans   = m_booleans;
+    Stack<Call>&         calls      = m_calls;
+
+    operations.clear();
+    types.clear();
+    reals.clear();
+    integers.clear();
+    strings.clear();
+    booleans.clear();
+    calls.clear();
+
+    auto popInteger = [&](std::int64_t& value) -> bool
+        {
+            switch (types.top())
+            {
+            case ::Execution::OPERAND_TYPE_INTEGER:
+                value = integers.top();
+                integers.pop();
+                break;
+
+            case ::Execution::OPERAND_TYPE_REAL:
+                value = static_cast<std::int64_t>(reals.top());
+                reals.pop();
+                break;
+
+            default:
+                m_err << TYPE_MISMATCH;
+                return false;
+            }
+
+            types.pop();
+            return true;
+        };
+
+    auto popString = [&](SharedString& value) -> bool
+        {
+            if (::Execution::OPERAND_TYPE_STRING != types.top())
+            {
+                m_err << TYPE_MISMATCH;
+                return false;
+            }
+
+            value = std::move(strings.top());
+            strings.pop();
+            types.pop();
+            return true;
+        };
+
+    auto loadElement = [&](const Operation& operation) -> bool
+        {
+            std::int64_t subscripts[MAX_ARRAY_DIMENSIONS];
+
+            if (MAX_ARRAY_DIMENSIONS < operation.totalOperands)
+            {
+                m_err << "Too many subscripts!\n";
+                return false;
+            }
+
+            for (std::size_t i = operation.totalOperands; i-- > 0;)
+            {
+                if (!popInteger(subscripts[i]))
+                    return false;
+            }
+
+            switch (operation.tokenValue)
+            {
+            case Token::IDENTIFIER_REAL:
+                {
+                    const long double* value = element(m_realArrays,
+                        *operation.token, subscripts, operation.totalOperands);
+
+                    if (nullptr == value)
+                        return false;
+
+                    types.push(::Execution::OPERAND_TYPE_REAL);
+                    reals.push(*value);
+                }
+                return true;
+
+            case Token::IDENTIFIER_INTEGER:
+                {
+                    const std::int64_t* value = element(m_intArrays,
+                        *operation.token, subscripts, operation.totalOperands);
+
+                    if (nullptr == value)
+                        return false;
+
+                    types.push(::Execution::OPERAND_TYPE_INTEGER);
+                    integers.push(*value);
+                }
+                return true;
+
+            default:
+                {
+                    const SharedString* value = element(m_strArrays,
+                        *operation.token, subscripts, operation.totalOperands);
+
+                    if (nullptr == value)
+                        return false;
+
+                    types.push(::Execution::OPERAND_TYPE_STRING);
+                    strings.push(*value);
+                }
+                return true;
+            }
+        };
+
+    auto performStringFunction = [&](
+        Token::Value function,
+        std::size_t  totalArguments) -> bool
+        {
+            std::size_t minArguments = 1;
+            std::size_t maxArguments = 1;
+
+            switch (function)
+            {
+            case Token::FUNCTION_LEFT:
+            case Token::FUNCTION_RIGHT:
+                minArguments = maxArguments = 2;
+                break;
+
+            case Token::FUNCTION_INSTR:
+            case Token::FUNCTION_MID:
+                minArguments = 2;
+                maxArguments = 3;
+                break;
+            }
+
+            if ((totalArguments < minArguments) ||
+                (totalArguments > maxArguments))
+            {
+                m_err << WRONG_NUMBER_OF_ARGUMENTS;
+                return false;
+            }
+
+            SharedString s;
+            SharedString t;
+            std::int64_t n = 0;
+            std::int64_t m = INT64_MAX;
+
+            switch (function)
+            {
+            case Token::FUNCTION_LEN:
+                if (!popString(s))
+                    return false;
+
+                types.push(::Execution::OPERAND_TYPE_INTEGER);
+                integers.push(static_cast<std::int64_t>(s.size()));
+                return true;
+
+            case Token::FUNCTION_LEFT:
+                if (!popInteger(n) || !popString(s))
+                    return false;
+
+                types.push(::Execution::OPERAND_TYPE_STRING);
+                strings.push(s.substr(0, static_cast<std::size_t>(
+                    std::max<std::int64_t>(n, 0))));
+                return true;
+
+            case Token::FUNCTION_RIGHT:
+                if (!popInteger(n) || !popString(s))
+                    return false;
+
+                n = std::min<std::int64_t>(std::max<std::int64_t>(n, 0),
+                    static_cast<std::int64_t>(s.size()));
+
+                types.push(::Execution::OPERAND_TYPE_STRING);
+                strings.push(s.substr(
+                    s.size() - static_cast<std::size_t>(n),
+                    static_cast<std::size_t>(n)));
+                return true;
+
+            case Token::FUNCTION_MID:
+                if (((3 == totalArguments) && !popInteger(m)) ||
+                    !popInteger(n) || !popString(s))
+                    return false;
+
+                n = std::max<std::int64_t>(n, 1);
+                m = std::max<std::int64_t>(m, 0);
+
+                types.push(::Execution::OPERAND_TYPE_STRING);
+                strings.push(s.substr(
+                    static_cast<std::size_t>(n - 1),
+                    static_cast<std::size_t>(m)));
+                return true;
+
+            case Token::FUNCTION_INSTR:
+                n = 1;
+
+                if (!popString(t) || !popString(s) ||
+                    ((3 == totalArguments) && !popInteger(n)))
+                    return false;
+
+                n = std::max<std::int64_t>(n, 1);
+
+                types.push(::Execution::OPERAND_TYPE_INTEGER);
+
+                if (static_cast<std::size_t>(n - 1) > s.size())
+                {
+                    integers.push(0);
+                }
+                else
+                {
+                    std::size_t offset = static_cast<std::size_t>(n - 1);
+                    std::size_t position = StringKernels::find(
+                        s.data() + offset, s.size() - offset,
+                        t.data(), t.size());
+
+                    integers.push(StringKernels::NOT_FOUND == position
+                        ? 0 : static_cast<std::int64_t>(offset + position + 1));
+                }
+                return true;
+
+            case Token::FUNCTION_LCASE:
+            case Token::FUNCTION_UCASE:
+                {
+                    if (!popString(s))
+                        return false;
+
+                    char* data;
+                    SharedString result = SharedString::uninitialized(
+                        s.size(), data);
+
+                    if (Token::FUNCTION_UCASE == function)
+                        StringKernels::toUpper(data, s.data(), s.size());
+                    else
+                        StringKernels::toLower(data, s.data(), s.size());
+
+                    types.push(::Execution::OPERAND_TYPE_STRING);
+                    strings.push(std::move(result));
+                }
+                return true;
+            }
+
+            m_err << TYPE_MISMATCH;
+            return false;
+        };
+
+    auto performProcessFunction = [&](Token::Value function) -> bool
+        {
+            std::string  command;
+            std::int64_t handle = 0;
+
+            if ((Token::FUNCTION_WAIT == function) ||
+                (Token::FUNCTION_WAIT_OUTPUT == function))
+            {
+                if (!popInteger(handle))
+                    return false;
+            }
+            else
+            {
+                SharedString text;
+
+                if (!popString(text))
+                    return false;
+
+                command = text.str();
+            }
+
+            CallResult result;
+
+            if (!call(function, command, handle, result))
+                return false;
+
+            switch (function)
+            {
+            case Token::FUNCTION_EXEC_OUTPUT:
+            case Token::FUNCTION_SHELL_OUTPUT:
+            case Token::FUNCTION_WAIT_OUTPUT:
+                types.push(::Execution::OPERAND_TYPE_STRING);
+                strings.push(SharedString(result.output));
+                break;
+
+            default:
+                types.push(::Execution::OPERAND_TYPE_INTEGER);
+                integers.push(result.status);
+                break;
+            }
+            return true;
+        };
+
+    auto performTopmostOperation = [&]() -> bool
+        {
+            auto operation = operations.top();
+            operations.pop();
+
+            if (types.size() < operation.totalOperands)
+            {
+                m_err << "Too few operands in expression!\n";
+                return false;
+            }
+
+            if ((operation.tokenValue & Token::TYPE_MASK) ==
+                Token::TYPE_IDENTIFIER)
+            {
+                return loadElement(operation);
+            }
+
+            if ((operation.tokenValue & Token::TYPE_MASK) ==
+                Token::TYPE_FUNCTION)
+            {
+                switch (operation.tokenValue)
+                {
+                case Token::FUNCTION_INSTR:
+                case Token::FUNCTION_LCASE:
+                case Token::FUNCTION_LEFT:
+                case Token::FUNCTION_LEN:
+                case Token::FUNCTION_MID:
+                case Token::FUNCTION_RIGHT:
+                case Token::FUNCTION_UCASE:
+                    return performStringFunction(
+                        operation.tokenValue, operation.totalOperands);
+                }
+
+                if (1 != operation.totalOperands)
+                {
+                    m_err << WRONG_NUMBER_OF_ARGUMENTS;
+                    return false;
+                }
+
+                switch (operation.tokenValue)
+                {
+                case Token::FUNCTION_EXEC:
+                case Token::FUNCTION_EXEC_OUTPUT:
+                case Token::FUNCTION_SHELL:
+                case Token::FUNCTION_SHELL_OUTPUT:
+                case Token::FUNCTION_SPAWN:
+                case Token::FUNCTION_WAIT:
+                case Token::FUNCTION_WAIT_OUTPUT:
+                    return performProcessFunction(operation.tokenValue);
+                }
+
+                if (::Execution::OPERAND_TYPE_STRING == types.top())
+                {
+                    switch (operation.tokenValue)
+                    {
+                    case Token::FUNCTION_VAL:
+                        {
+                            long double value;
+
+                            if (!parseReal(strings.top().str(), value))
+                            {
+                                m_err << "Bad number in VAL!\n";
+                                return false;
+                            }
+
+                            types.top() = ::Execution::OPERAND_TYPE_REAL;
+                            reals.push(value);
+                            strings.pop();
+                        }
+                        return true;
+                    }
+                }
+
+                if (::Execution::OPERAND_TYPE_INTEGER == types.top())
+                {
+                    switch (operation.tokenValue)
+                    {
+                    case Token::FUNCTION_ABS:
+                        integers.top() = std::abs(integers.top());
+                        return true;
+
+                    case Token::FUNCTION_RND:
+                        integers.top() = drawInteger(random(), integers.top());
+                        return true;
+
+                    case Token::FUNCTION_SGN:
+                        integers.top() = (0 == integers.top())
+                            ? 0 : integers.top() / std::abs(integers.top());
+                        return true;
+                    }
+
+                    types.top() = ::Execution::OPERAND_TYPE_REAL;
+                    reals.push(static_cast<long double>(integers.top()));
+                    integers.pop();
+                }
+
+                if (::Execution::OPERAND_TYPE_REAL == types.top())
+                {
+                    switch (operation.tokenValue)
+                    {
+                    case Token::FUNCTION_ABS:
+                        reals.top() = std::abs(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_ATN:
+                        reals.top() = std::atan(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_COS:
+                        reals.top() = std::cos(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_FIX:
+                        reals.top() = std::floor(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_LOG:
+                        reals.top() = std::log(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_RND:
+                        reals.top() *= random().real();
+                        return true;
+
+                    case Token::FUNCTION_SGN:
+                        reals.top() = (0 == reals.top())
+                            ? 0 : reals.top() / std::abs(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_SIN:
+                        reals.top() = std::sin(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_SQR:
+                        reals.top() = std::sqrt(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_TAN:
+                        reals.top() = std::tan(reals.top());
+                        return true;
+
+                    case Token::FUNCTION_EXP:
+                        {
+                            int exp;
+                            std::frexp(reals.top(), &exp);
+                            reals.pop();
+                            types.top() = ::Execution::OPERAND_TYPE_INTEGER;
+                            integers.push(exp);
+                        }
+                        return true;
+
+                    case Token::FUNCTION_INT:
+                        {
+                            types.top() = ::Execution::OPERAND_TYPE_INTEGER;
+                            integers.push(static_cast<std::int64_t>(
+                                std::floor(reals.top())));
+                            reals.pop();
+                        }
+                        return true;
+                    }
+                }
+            }
+            else
+            {
+                assert((operation.tokenValue & Token::TYPE_MASK) ==
+                    Token::TYPE_OPERATOR);
+
+                switch (operation.totalOperands)
+                {
+                case 1:
+                    switch (operation.tokenValue)
+                    {
+                    case Token::OPERATOR_ADD:
+                        if ((::Execution::OPERAND_TYPE_REAL    != types.top()) &&
+                            (::Execution::OPERAND_TYPE_INTEGER != types.top()))
+                        {
+                            m_err << TYPE_MISMATCH;
+                            return false;
+                        }
+                        return true;
+
+                    case Token::OPERATOR_SUBTRACT:
+                        switch (types.top())
+                        {
+                        case ::Execution::OPERAND_TYPE_REAL:
+                            reals.top() = -reals.top();
+                            return true;
+
+                        case ::Execution::OPERAND_TYPE_INTEGER:
+                            integers.top() = -integers.top();
+                            return true;
+                        }
+                        m_err << TYPE_MISMATCH;
+                        return false;
+
+                    case Token::OPERATOR_NOT:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN == types.top())
+                        {
+                            booleans.top() = !booleans.top();
+                            return true;
+                        }
+                        m_err << TYPE_MISMATCH;
+                        return false;
+                    }
+                    break;
+
+                case 2:
+                    auto typeOfB = types.top();
+                    types.pop();
+
+                    auto typeOfA = types.top();
+
+                    ::Execution::OperandType operandsType =
+                        ::Execution::OPERAND_TYPE_REAL;
+
+                    if ((::Execution::OPERAND_TYPE_BOOLEAN == typeOfA) ||
+                        (::Execution::OPERAND_TYPE_BOOLEAN == typeOfB))
+                    {
+                        if (typeOfA != typeOfB)
+                        {
+                            m_err << TYPE_MISMATCH;
+                            return false;
+                        }
+                        operandsType = ::Execution::OPERAND_TYPE_BOOLEAN;
+                    }
+                    else if ((::Execution::OPERAND_TYPE_INTEGER == typeOfA) &&
+                             (::Execution::OPERAND_TYPE_INTEGER == typeOfB))
+                    {
+                        operandsType = ::Execution::OPERAND_TYPE_INTEGER;
+                    }
+                    else if ((::Execution::OPERAND_TYPE_STRING == typeOfA) ||
+                             (::Execution::OPERAND_TYPE_STRING == typeOfB))
+                    {
+                        if (typeOfA != typeOfB)
+                        {
+                            bool nonStrA =
+                                ::Execution::OPERAND_TYPE_STRING != typeOfA;
+
+                            auto type = (nonStrA ? typeOfA : typeOfB);
+
+                            std::stringstream result;
+
+                            switch (type)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                result << reals.top();
+                                reals.pop();
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                result << integers.top();
+                                integers.pop();
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_BOOLEAN:
+                                m_err << TYPE_MISMATCH;
+                                return false;
+                            }
+
+                            SharedString converted(result.str());
+
+                            if (nonStrA)
+                                std::swap(strings.top(), converted);
+
+                            strings.push(std::move(converted));
+                        }
+                        operandsType = ::Execution::OPERAND_TYPE_STRING;
+                    }
+                    else
+                    {
+                        if (typeOfA != typeOfB)
+                        {
+                            bool nonRealA =
+                                ::Execution::OPERAND_TYPE_REAL != typeOfA;
+
+                            long double result = static_cast<long double>(
+                                integers.top());
+
+                            integers.pop();
+
+                            if (nonRealA)
+                                std::swap(reals.top(), result);
+
+                            reals.push(result);
+                        }
+                    }
+
+                    types.top() = operandsType;
+
+                    switch (operation.tokenValue)
+                    {
+                    case Token::OPERATOR_ADD:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN != operandsType)
+                        {
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto t = reals.top();
+                                    reals.pop();
+                                    reals.top() += t;
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto t = integers.top();
+                                    integers.pop();
+                                    integers.top() += t;
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_STRING:
+                                {
+                                    auto t = std::move(strings.top());
+                                    strings.pop();
+                                    strings.top().append(t);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_AND:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN == operandsType)
+                        {
+                            auto t = booleans.top();
+                            booleans.pop();
+                            booleans.top() = booleans.top() && t;
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_DIVIDE:
+                        if ((::Execution::OPERAND_TYPE_BOOLEAN != operandsType) &&
+                            (::Execution::OPERAND_TYPE_STRING  != operandsType))
+                        {
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto t = reals.top();
+                                    reals.pop();
+
+                                    if (0 == t)
+                                    {
+                                        m_err << DIVISION_BY_ZERO;
+                                        return false;
+                                    }
+
+                                    reals.top() /= t;
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    types.top() = ::Execution::OPERAND_TYPE_REAL;
+
+                                    auto b = integers.top();
+                                    integers.pop();
+                                    auto a = integers.top();
+                                    integers.pop();
+
+                                    if (0 == b)
+                                    {
+                                        m_err << DIVISION_BY_ZERO;
+                                        return false;
+                                    }
+
+                                    reals.push(static_cast<long double>(a) / b);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_EQUAL:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN != operandsType)
+                        {
+                            types.top() = ::Execution::OPERAND_TYPE_BOOLEAN;
+
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto b = reals.top();
+                                    reals.pop();
+                                    auto a = reals.top();
+                                    reals.pop();
+
+                                    booleans.push(a == b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto b = integers.top();
+                                    integers.pop();
+                                    auto a = integers.top();
+                                    integers.pop();
+
+                                    booleans.push(a == b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_STRING:
+                                {
+                                    auto b = std::move(strings.top());
+                                    strings.pop();
+                                    auto a = std::move(strings.top());
+                                    strings.pop();
+
+                                    booleans.push(a == b);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_GREATER:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN != operandsType)
+                        {
+                            types.top() = ::Execution::OPERAND_TYPE_BOOLEAN;
+
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto b = reals.top();
+                                    reals.pop();
+                                    auto a = reals.top();
+                                    reals.pop();
+
+                                    booleans.push(a > b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto b = integers.top();
+                                    integers.pop();
+                                    auto a = integers.top();
+                                    integers.pop();
+
+                                    booleans.push(a > b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_STRING:
+                                {
+                                    auto b = std::move(strings.top());
+                                    strings.pop();
+                                    auto a = std::move(strings.top());
+                                    strings.pop();
+
+                                    booleans.push(a > b);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_GREATER_OR_EQUAL:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN != operandsType)
+                        {
+                            types.top() = ::Execution::OPERAND_TYPE_BOOLEAN;
+
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto b = reals.top();
+                                    reals.pop();
+                                    auto a = reals.top();
+                                    reals.pop();
+
+                                    booleans.push(a >= b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto b = integers.top();
+                                    integers.pop();
+                                    auto a = integers.top();
+                                    integers.pop();
+
+                                    booleans.push(a >= b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_STRING:
+                                {
+                                    auto b = std::move(strings.top());
+                                    strings.pop();
+                                    auto a = std::move(strings.top());
+                                    strings.pop();
+
+                                    booleans.push(a >= b);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_INEQUAL:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN != operandsType)
+                        {
+                            types.top() = ::Execution::OPERAND_TYPE_BOOLEAN;
+
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto b = reals.top();
+                                    reals.pop();
+                                    auto a = reals.top();
+                                    reals.pop();
+
+                                    booleans.push(a != b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto b = integers.top();
+                                    integers.pop();
+                                    auto a = integers.top();
+                                    integers.pop();
+
+                                    booleans.push(a != b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_STRING:
+                                {
+                                    auto b = std::move(strings.top());
+                                    strings.pop();
+                                    auto a = std::move(strings.top());
+                                    strings.pop();
+
+                                    booleans.push(a != b);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_INTEGER_DIVIDE:
+                        if ((::Execution::OPERAND_TYPE_BOOLEAN != operandsType) &&
+                            (::Execution::OPERAND_TYPE_STRING  != operandsType))
+                        {
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    types.top() = ::Execution::OPERAND_TYPE_INTEGER;
+
+                                    auto b = reals.top();
+                                    reals.pop();
+                                    auto a = reals.top();
+                                    reals.pop();
+
+                                    if (0 == b)
+                                    {
+                                        m_err << DIVISION_BY_ZERO;
+                                        return false;
+                                    }
+
+                                    integers.push(
+                                        static_cast<std::int64_t>(a) /
+                                        static_cast<std::int64_t>(b));
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto t = integers.top();
+                                    integers.pop();
+
+                                    if (0 == t)
+                                    {
+                                        m_err << DIVISION_BY_ZERO;
+                                        return false;
+                                    }
+
+                                    integers.top() /= t;
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_LESS:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN != operandsType)
+                        {
+                            types.top() = ::Execution::OPERAND_TYPE_BOOLEAN;
+
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto b = reals.top();
+                                    reals.pop();
+                                    auto a = reals.top();
+                                    reals.pop();
+
+                                    booleans.push(a < b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto b = integers.top();
+                                    integers.pop();
+                                    auto a = integers.top();
+                                    integers.pop();
+
+                                    booleans.push(a < b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_STRING:
+                                {
+                                    auto b = std::move(strings.top());
+                                    strings.pop();
+                                    auto a = std::move(strings.top());
+                                    strings.pop();
+
+                                    booleans.push(a < b);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_LESS_OR_EQUAL:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN != operandsType)
+                        {
+                            types.top() = ::Execution::OPERAND_TYPE_BOOLEAN;
+
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto b = reals.top();
+                                    reals.pop();
+                                    auto a = reals.top();
+                                    reals.pop();
+
+                                    booleans.push(a <= b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto b = integers.top();
+                                    integers.pop();
+                                    auto a = integers.top();
+                                    integers.pop();
+
+                                    booleans.push(a <= b);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_STRING:
+                                {
+                                    auto b = std::move(strings.top());
+                                    strings.pop();
+                                    auto a = std::move(strings.top());
+                                    strings.pop();
+
+                                    booleans.push(a <= b);
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_MODULO:
+                        if ((::Execution::OPERAND_TYPE_BOOLEAN != operandsType) &&
+                            (::Execution::OPERAND_TYPE_STRING  != operandsType))
+                        {
+                            std::int64_t a;
+                            std::int64_t b;
+                            if (operandsType == ::Execution::OPERAND_TYPE_REAL)
+                            {
+                                b = static_cast<std::int64_t>(reals.top());
+                                reals.pop();
+                                a = static_cast<std::int64_t>(reals.top());
+                                reals.pop();
+                            }
+                            else
+                            {
+                                b = integers.top();
+                                integers.pop();
+                                a = integers.top();
+                                integers.pop();
+                            }
+                            integers.push(a % b);
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_MULTIPLY:
+                        if ((::Execution::OPERAND_TYPE_BOOLEAN != operandsType) &&
+                            (::Execution::OPERAND_TYPE_STRING  != operandsType))
+                        {
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto t = reals.top();
+                                    reals.pop();
+                                    reals.top() *= t;
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto t = integers.top();
+                                    integers.pop();
+                                    integers.top() *= t;
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_OR:
+                        if (::Execution::OPERAND_TYPE_BOOLEAN == operandsType)
+                        {
+                            auto t = booleans.top();
+                            booleans.pop();
+                            booleans.top() = booleans.top() || t;
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_POWER:
+                        if ((::Execution::OPERAND_TYPE_BOOLEAN != operandsType) &&
+                            (::Execution::OPERAND_TYPE_STRING  != operandsType))
+                        {
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto t = reals.top();
+                                    reals.pop();
+                                    reals.top() = std::pow(reals.top(), t);
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto t = integers.top();
+                                    integers.pop();
+                                    integers.top() = static_cast<std::int64_t>(
+                                        std::pow(
+                                            static_cast<long double>(
+                                                integers.top()),
+                                            static_cast<int>(t)));
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+
+                    case Token::OPERATOR_SUBTRACT:
+                        if ((::Execution::OPERAND_TYPE_BOOLEAN != operandsType) &&
+                            (::Execution::OPERAND_TYPE_STRING  != operandsType))
+                        {
+                            switch (operandsType)
+                            {
+                            case ::Execution::OPERAND_TYPE_REAL:
+                                {
+                                    auto t = reals.top();
+                                    reals.pop();
+                                    reals.top() -= t;
+                                }
+                                break;
+
+                            case ::Execution::OPERAND_TYPE_INTEGER:
+                                {
+                                    auto t = integers.top();
+                                    integers.pop();
+                                    integers.top() -= t;
+                                }
+                                break;
+                            }
+                            return true;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            m_err << TYPE_MISMATCH;
+            return false;
+        };
+
+    enum State
+    {
+        STATE_A,
+        STATE_B
+    };
+
+    const int PRIORITY_STEP = 10;
+
+    int priorityBase = 0;
+
+    const VectorOfTokens::const_iterator first = begin;
+
+    State state = STATE_A;
+
+    for (; begin != end; begin++)
+    {
+        switch (state)
+        {
+        case STATE_A:
+            if ((Token::TYPE_IDENTIFIER == begin->getType()) &&
+                (end - begin > 1) &&
+                (Token::PUNCTUATION_MARK_PARENTHESIS_LEFT ==
+                    (begin + 1)->getValue()))
+            {
+                // Array element; it is loaded once its subscripts are known.
+                Operation operation;
+                operation.tokenValue    = begin->getValue();
+                operation.totalOperands = 0;
+                operation.priority      = priorityBase + 6;
+                operation.token         = &*begin;
+                operations.push(operation);
+            }
+            else if ((Token::TYPE_IDENTIFIER == begin->getType()) ||
+                     (Token::TYPE_LITERAL    == begin->getType()))
+            {
+                bool isLiteral = (Token::TYPE_LITERAL == begin->getType());
+
+                switch (begin->getValue())
+                {
+                case Token::IDENTIFIER_REAL:
+                case Token::LITERAL_REAL:
+                    types.push(OPERAND_TYPE_REAL);
+                    reals.push(isLiteral 
+                        ? begin->getReal()
+                        : named(m_realVars, getName(*begin)));
+                    break;
+
+                case Token::IDENTIFIER_INTEGER:
+                case Token::LITERAL_INTEGER:
+                    types.push(OPERAND_TYPE_INTEGER);
+                    integers.push(isLiteral 
+                        ? begin->getInteger()
+                        : named(m_intVars, getName(*begin)));
+                    break;
+
+                case Token::IDENTIFIER_STRING:
+                case Token::LITERAL_STRING:
+                    types.push(OPERAND_TYPE_STRING);
+                    strings.push(isLiteral 
+                        ? begin->getLiteralString()
+                        : named(m_strVars, getName(*begin)));
+                    break;
+                }
+
+                state = STATE_B;
+            }
+            else if (Token::TYPE_OPERATOR == begin->getType())
+            {
+                if ((Token::OPERATOR_ADD      == begin->getValue()) ||
+                    (Token::OPERATOR_SUBTRACT == begin->getValue()) ||
+                    (Token::OPERATOR_NOT      == begin->getValue()))
+                {
+                    Operation operation;
+                    operation.tokenValue    = begin->getValue();
+                    operation.totalOperands = 1;
+                    operation.priority = priorityBase +
+                        ((Token::OPERATOR_NOT == operation.tokenValue)
+                        ? 2 : 8);
+                    operations.push(operation);
+                }
+                else
+                {
+                    m_err << "Unexpected operator!\n";
+                    return false;
+                }
+            }
+            else if (Token::TYPE_FUNCTION == begin->getType())
+            {
+                Operation operation;
+                operation.tokenValue    = begin->getValue();
+                operation.totalOperands = 1;
+                operation.priority      = priorityBase + 6;
+                operations.push(operation);
+            }
+            else if (Token::TYPE_PUNCTUATION_MARK == begin->getType())
+            {
+                switch (begin->getValue())
+                {
+                case Token::PUNCTUATION_MARK_PARENTHESIS_LEFT:
+                    priorityBase += PRIORITY_STEP;
+
+                    if ((first != begin) &&
+                        ((Token::TYPE_FUNCTION   == (begin - 1)->getType()) ||
+                         (Token::TYPE_IDENTIFIER == (begin - 1)->getType())))
+                    {
+                        Call call;
+                        call.priorityBase   = priorityBase;
+                        call.totalArguments = 1;
+                        calls.push(call);
+                    }
+                    break;
+
+                case Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT:
+                    m_err << "Unexpected closing parenthesis!\n";
+                    return false;
+
+                default:
+                    m_err << UNEXPECTED_PUNCTUATION_MARK;
+                    return false;
+                }
+            }
+            else
+            {
+                m_err << BAD_EXPRESSION;
+                return false;
+            }
+            break;
+
+        case STATE_B:
+            if (Token::TYPE_OPERATOR == begin->getType())
+            {
+                Operation operation;
+                operation.tokenValue    = begin->getValue();
+                operation.totalOperands = 2;
+
+                switch (operation.tokenValue)
+                {
+                case Token::OPERATOR_AND:
+                case Token::OPERATOR_OR:
+                    operation.priority = priorityBase + 1;
+                    break;
+
+                case Token::OPERATOR_EQUAL:
+                case Token::OPERATOR_GREATER:
+                case Token::OPERATOR_GREATER_OR_EQUAL:
+                case Token::OPERATOR_INEQUAL:
+                case Token::OPERATOR_LESS:
+                case Token::OPERATOR_LESS_OR_EQUAL:
+                    operation.priority = priorityBase + 3;
+                    break;
+
+                case Token::OPERATOR_ADD:        
+                case Token::OPERATOR_SUBTRACT:
+                    operation.priority = priorityBase + 4;
+                    break;
+
+                case Token::OPERATOR_DIVIDE:
+                case Token::OPERATOR_INTEGER_DIVIDE:
+                case Token::OPERATOR_MODULO:
+                case Token::OPERATOR_MULTIPLY:
+                    operation.priority = priorityBase + 5;
+                    break;
+
+                case Token::OPERATOR_POWER:
+                    operation.priority = priorityBase + 7;
+                    break;
+                }
+
+                while ((!operations.empty()) && 
+                    (operations.top().priority >= operation.priority))
+                {
+                    if (!performTopmostOperation())
+                        return false;
+                }
+
+                operations.push(operation);
+                state = STATE_A;
+            }
+            else if (Token::TYPE_PUNCTUATION_MARK == begin->getType())
+            {
+                switch (begin->getValue())
+                {
+                case Token::PUNCTUATION_MARK_PARENTHESIS_LEFT:
+                    m_err << "Unexpected opening parenthesis!\n";
+                    return false;
+
+                case Token::PUNCTUATION_MARK_PARENTHESIS_RIGHT:
+                    if (!calls.empty() &&
+                        (calls.top().priorityBase == priorityBase))
+                    {
+                        // Leaves the function or array on top of the
+                        // operation stack so that it learns how many
+                        // arguments it has got, then applies it at once.
+                        while (operations.top().priority >= priorityBase)
+                        {
+                            if (!performTopmostOperation())
+                                return false;
+                        }
+
+                        operations.top().totalOperands =
+                            calls.top().totalArguments;
+                        calls.pop();
+
+                        if (!performTopmostOperation())
+                            return false;
+                    }
+
+                    priorityBase -= PRIORITY_STEP;
+                    if (priorityBase < 0)
+                    {
+                        m_err << "Unmatched closing parenthesis!\n";
+                        return false;
+                    }
+                    break;
+
+                case Token::PUNCTUATION_MARK_COMMA:
+                    if (calls.empty() ||
+                        (calls.top().priorityBase != priorityBase))
+                    {
+                        m_err << UNEXPECTED_PUNCTUATION_MARK;
+                        return false;
+                    }
+
+                    while (operations.top().priority >= priorityBase)
+                    {
+                        if (!performTopmostOperation())
+                            return false;
+                    }
+
+                    calls.top().totalArguments++;
+                    state = STATE_A;
+                    break;
+
+                default:
+                    m_err << UNEXPECTED_PUNCTUATION_MARK;
+                    return false;
+                }
+            }            
+            else
+            {
+                m_err << BAD_EXPRESSION;
+                return false;
+            }
+            break;
+        };
+    }
+
+    if (0 != priorityBase)
+    {
+        m_err << "Unmatched opening parenthesis!\n";
+        return false;
+    }
+
+    while (!operations.empty())
+        if (!performTopmostOperation())
+            return false;
+
+    if (1 != types.size())
+    {
+        m_err << BAD_EXPRESSION;
+        return false;
+    }
+
+    // Callers that take any type get the expression's own.
+    OperandType targetType = varType;
+
+    if (nullptr != resultType)
+        targetType = *resultType = types.top();
+
+    if (targetType != types.top())
+    {
+        if ((OPERAND_TYPE_REAL    == types.top()) &&
+            (OPERAND_TYPE_INTEGER == targetType))
+        {
+            integers.push(static_cast<std::int64_t>(reals.top()));
+        }
+        else if ((OPERAND_TYPE_INTEGER == types.top()) &&
+                 (OPERAND_TYPE_REAL    == targetType))
+        {
+            reals.push(static_cast<long double>(integers.top()));
+        }
+        else if (OPERAND_TYPE_STRING == targetType)
+        {
+            std::stringstream result;
+
+            switch (types.top())
+            {
+            case OPERAND_TYPE_REAL:
+                result << reals.top();
+                break;
+
+            case OPERAND_TYPE_INTEGER:
+                result << integers.top();
+                break;
+
+            default:
+                m_err << TYPE_MISMATCH;
+                return false;
+            }
+
+            strings.push(SharedString(result.str()));
+        }
+        else
+        {
+            m_err << TYPE_MISMATCH;
+            return false;
+        }
+
+        types.top() = targetType;
+    }
+
+    switch (targetType)
+    {
+    case OPERAND_TYPE_REAL:
+        assert(!reals.empty());
+        named(m_realVars, varResult) = reals.top();
+        break;
+
+    case OPERAND_TYPE_INTEGER:
+        assert(!integers.empty());
+        named(m_intVars, varResult) = integers.top();
+        break;
+
+    case OPERAND_TYPE_STRING:
+        assert(!strings.empty());
+        storeString(named(m_strVars, varResult), std::move(strings.top()));
+        break;
+
+    case OPERAND_TYPE_BOOLEAN:
+        assert(!booleans.empty());
+        boolResult = 0 != booleans.top();
+        break;
+    }
+
+    return true;
+}
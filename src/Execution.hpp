@@ -0,0 +1,661 @@
+#ifndef EXECUTION_HPP_INCLUDED
+#define EXECUTION_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <map>
+#include <memory_resource>
+#include <stack>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <sstream>
+#include "AllocationProfiler.hpp"
+#include "Arena.hpp"
+#include "Channel.hpp"
+#include "Governor.hpp"
+#include "Metrics.hpp"
+#include "PerfMap.hpp"
+#include "Process.hpp"
+#include "Profiler.hpp"
+#include "Program.hpp"
+#include "Random.hpp"
+#include "Recording.hpp"
+#include "Sampler.hpp"
+#include "Token.hpp"
+#include "Trace.hpp"
+
+// One run of a Program: variables, arrays, the GOSUB call stack, streams
+// and the random number generator. The program itself is only read, so
+// many executions can share it.
+class Execution
+{
+public:
+
+    enum OperandType
+    {
+        OPERAND_TYPE_REAL,
+        OPERAND_TYPE_INTEGER,
+        OPERAND_TYPE_STRING,
+        OPERAND_TYPE_BOOLEAN
+    };
+
+    // Where a resumable run stands after resume().
+    enum Status
+    {
+        STATUS_READY,
+        STATUS_WAITING_INPUT,
+        STATUS_WAITING_SHELL,
+        STATUS_WAITING_CHANNEL,
+        STATUS_FINISHED,
+        STATUS_FAILED
+    };
+
+    // Programs read INPUT from in, PRINT to out and report errors to err.
+    // Executions share no mutable state, so each can run on its own
+    // thread. The program must outlive the execution.
+    //
+    // The state of a run lives in the arena, which is rewound here and at
+    // the start of every run; hosts that create many executions one after
+    // another pass the same arena to each, and must not use it for
+    // anything else meanwhile. Without one, the execution has its own.
+    explicit Execution(
+        const Program& program,
+        std::istream&  in  = std::cin,
+        std::ostream&  out = std::cout,
+        std::ostream&  err = std::cerr,
+        Arena*         arena = nullptr)
+        : m_program(program)
+        , m_tokens(program.getTokens())
+        , m_in(in)
+        , m_out(out)
+        , m_err(err)
+        , m_ownArena((nullptr == arena) ? new Arena : nullptr)
+        , m_arena((nullptr == arena) ? m_ownArena.get() : arena)
+        , m_isSeeded(false)
+        , m_seed(0)
+        , m_stream(0)
+        , m_isRandomSaved(false)
+        , m_profiler(nullptr)
+        , m_sampler(nullptr)
+        , m_perfMap(nullptr)
+        , m_metrics(nullptr)
+        , m_allocationProfiler(nullptr)
+        , m_recorder(nullptr)
+        , m_replay(nullptr)
+        , m_isResumable(false)
+        , m_isSuspending(false)
+        , m_countedStatements(0)
+        , m_countedEvaluations(0)
+        , m_recountedStatements(0)
+        , m_recountedEvaluations(0)
+        , m_status(STATUS_FINISHED)
+        , m_line(0)
+        , m_isInputClosed(false)
+        , m_callFunction(Token::INVALID)
+        , m_callHandle(0)
+        , m_callNext(0)
+        , m_nextProcess(1)
+        , m_memoryBytes(0)
+        , m_arrayBytes(0)
+        , m_isCheckpointRequested(false)
+        , m_isRestored(false)
+        , m_isTraceRequested(false)
+        , m_channels(nullptr)
+        , m_waitChannel(nullptr)
+        , m_isWaitingToSend(false)
+        , m_realVars(m_arena)
+        , m_intVars(m_arena)
+        , m_strVars(m_arena)
+        , m_realArrays(m_arena)
+        , m_intArrays(m_arena)
+        , m_strArrays(m_arena)
+        , m_callStack(m_arena)
+        , m_operations(m_arena)
+        , m_types(m_arena)
+        , m_reals(m_arena)
+        , m_integers(m_arena)
+        , m_strings(m_arena)
+        , m_booleans(m_arena)
+        , m_calls(m_arena)
+        , m_elses(m_arena)
+    {
+        m_arena->rewind();
+    }
+
+    bool run();
+
+    // Resumable run: start() resets everything as run() does, then each
+    // resume() runs at most budget lines and returns rather than block on
+    // INPUT or SHELL. A statement that has to wait runs again from its
+    // start once the host has supplied what it waits for; its RND draws
+    // and earlier SHELL results are replayed and its PRINT output is held
+    // back until it completes. Profilers are not used here.
+    void start();
+    Status resume(std::size_t budget = SIZE_MAX);
+    Status getStatus() const { return m_status; }
+
+    // INPUT reads one whole line of this text per statement; once the
+    // input is closed it sees end of file as on a stream. start() drops
+    // whatever was left over.
+    void provideInput(const std::string& text) { m_input.append(text); }
+    void closeInput() { m_isInputClosed = true; }
+
+    // Follows the program to its new version after Program::reload(),
+    // between resume() calls. Variables and arrays stay as they are; the
+    // strings among them that refer to the program's text get copies of
+    // their own, so that the program can release its retired lines
+    // afterwards. The run goes on at the line now standing where its next
+    // line stood, changed or not, but every GOSUB under way must return
+    // to a line that is unchanged; otherwise the run fails and returns
+    // false, and can only be started anew.
+    bool relocate(const Program::LineMap& lineMap);
+
+    // Runs the SHELL, EXEC or WAIT call a STATUS_WAITING_SHELL run waits
+    // for, on whatever thread suits the host, for resume() to pick up.
+    void completeCall();
+
+    // Every run starts RND from this seed; by default each run draws a
+    // fresh seed from std::random_device. RANDOMIZE seeds it again.
+    void setSeed(std::uint64_t seed) { m_seed = seed; m_isSeeded = true; }
+
+    // Runs that share a seed but not a stream draw sequences that never
+    // overlap: every seeding of RND jumps its generator ahead by 2^128
+    // numbers this many times (see Random::jump()), so streams are meant
+    // to be few, one per parallel run of a Monte Carlo job, say.
+    void setStream(std::uint64_t stream) { m_stream = stream; }
+
+    // Lines are counted from the start of execution; pass nullptr to stop
+    // profiling. The profiler must outlive the runs it records.
+    void setProfiler(Profiler* profiler) { m_profiler = profiler; }
+
+    // Same for the sampling profiler. The per-line profiler takes
+    // precedence when both are set.
+    void setSampler(Sampler* sampler) { m_sampler = sampler; }
+
+    // Runs every line through its own stub of generated code, listed in a
+    // perf map file. Ignored while one of the profilers above is set.
+    void setPerfMap(PerfMap* perfMap) { m_perfMap = perfMap; }
+
+    // Counts the heap allocations of every line; see AllocationProfiler.
+    // Ignored while any of the above is set.
+    void setAllocationProfiler(AllocationProfiler* profiler) { m_allocationProfiler = profiler; }
+
+    // Every run records its RND seed, what INPUT reads and what process
+    // functions return into the recorder, which it clears first; pass
+    // nullptr, the default, to stop.
+    void setRecorder(Recording* recorder) { m_recorder = recorder; }
+
+    // Every run takes those values from the replay instead, from its
+    // start: INPUT reads the recorded text and nothing waits for the host,
+    // and no process is started. Channels are not recorded, so runs that
+    // RECEIVE may still differ. Pass nullptr, the default, to stop.
+    void setReplay(Recording* replay) { m_replay = replay; }
+
+    // Counts statements, jumps, I/O and waits into the registry; pass
+    // nullptr, the default, to stop. Gauges are brought up to date every
+    // CHECK_INTERVAL statements and when a run or a resume() ends.
+    void setMetrics(Metrics* metrics) { m_metrics = metrics; }
+
+    // Registry that SEND and RECEIVE look channel names up in; nullptr,
+    // the default, stands for Channels::getDefault(). A run that cannot
+    // send or receive at once blocks in run(), while resume() returns
+    // STATUS_WAITING_CHANNEL, so that the host can park it on the channel
+    // it waits for.
+    void setChannels(Channels* channels) { m_channels = channels; }
+
+    Channel* getWaitChannel() const { return m_waitChannel; }
+    bool isWaitingToSend() const { return m_isWaitingToSend; }
+
+    // Limits checked while the program runs; a run that hits one fails
+    // with an error. The GOSUB depth is always limited.
+    void setLimits(const Governor::Limits& limits) { m_governor.setLimits(limits); }
+
+    // Makes resume() return STATUS_READY after running for this long, or
+    // soon after preempt() is called from another thread. Runs started
+    // with run() ignore both.
+    void setTimeSlice(double seconds) { m_governor.setTimeSlice(seconds); }
+    void preempt() { m_governor.preempt(); }
+
+    // File that CHECKPOINT statements without a file name, and requested
+    // checkpoints, write the state of the run to: the line it has reached,
+    // variables, arrays, GOSUB return lines and the random number
+    // generator. Children started by SPAWN and pending input are not
+    // kept. The file is replaced only once the new checkpoint is complete.
+    void setCheckpointFile(const std::string& fileName) { m_checkpointFile = fileName; }
+
+    // Makes the run write a checkpoint at its next check, at most
+    // CHECK_INTERVAL statements later. Safe to call from any thread and
+    // from a signal handler.
+    void requestCheckpoint() { m_isCheckpointRequested.store(true, std::memory_order_relaxed); }
+
+    // Every run keeps its last Trace::CAPACITY lines; one that fails
+    // writes them to this file, if it is set. See Trace.
+    void setTraceFile(const std::string& fileName) { m_traceFile = fileName; }
+
+    // Makes the run write its trace file at its next check, as above.
+    void requestTrace() { m_isTraceRequested.store(true, std::memory_order_relaxed); }
+
+    const Trace& getTrace() const { return m_trace; }
+
+    // Reads a checkpoint of a run of the same program; the next run() or
+    // start() goes on from there instead of the first line. Errors are
+    // reported to err and leave everything as it was.
+    bool restore(std::istream& file);
+
+    // Statements started since the run began.
+    std::uint64_t getTotalStatements() const { return m_governor.getTotalStatements(); }
+
+    const Program& getProgram() const { return m_program; }
+
+private:
+
+    typedef Program::VectorOfTokens VectorOfTokens;
+
+    const Program&                     m_program;
+    const std::vector<VectorOfTokens>& m_tokens;
+
+    std::istream& m_in;
+    std::ostream& m_out;
+    std::ostream& m_err;
+
+    // Before everything allocated from it.
+    std::unique_ptr<Arena> m_ownArena;
+    Arena*                 m_arena;
+
+    Random        m_random;
+    bool          m_isSeeded;
+    std::uint64_t m_seed;
+    std::uint64_t m_stream;
+
+    // Generator state before the first draw of the current statement, for
+    // restarting it; only kept in a resumable run.
+    Random        m_savedRandom;
+    bool          m_isRandomSaved;
+
+    Profiler* m_profiler;
+    Sampler*  m_sampler;
+    PerfMap*  m_perfMap;
+    Metrics*  m_metrics;
+
+    AllocationProfiler* m_allocationProfiler;
+
+    Recording*         m_recorder;
+    Recording*         m_replay;
+    std::istringstream m_replayIn;
+
+    bool               m_isResumable;
+    bool               m_isSuspending;
+
+    // Statements and evaluations the line being run has met so far, and
+    // how many of them an attempt that waited has counted already; a
+    // statement that runs again from its start is counted once.
+    std::size_t        m_countedStatements;
+    std::size_t        m_countedEvaluations;
+    std::size_t        m_recountedStatements;
+    std::size_t        m_recountedEvaluations;
+
+    Status             m_status;
+    std::size_t        m_line;
+    std::string        m_input;
+    bool               m_isInputClosed;
+    std::ostringstream m_printBuffer;
+
+    // What a process function returned; a resumable run keeps those of the
+    // current statement for replaying it.
+    struct CallResult
+    {
+        std::int64_t status;
+        std::string  output;
+    };
+
+    Token::Value            m_callFunction;
+    std::string             m_callCommand;
+    std::int64_t            m_callHandle;
+    std::vector<CallResult> m_callResults;
+    std::size_t             m_callNext;
+
+    // Children started by SPAWN, by handle, until WAIT collects them.
+    std::map<std::int64_t, std::unique_ptr<Process>> m_processes;
+    std::int64_t                                     m_nextProcess;
+
+    Governor m_governor;
+
+    // Array elements and the contents of string variables and elements,
+    // in bytes; see getMemoryUsage(). The elements alone are m_arrayBytes.
+    std::size_t m_memoryBytes;
+    std::size_t m_arrayBytes;
+
+    std::string       m_checkpointFile;
+    std::atomic<bool> m_isCheckpointRequested;
+    bool              m_isRestored;
+
+    Trace             m_trace;
+    std::string       m_traceFile;
+    std::atomic<bool> m_isTraceRequested;
+
+    Channels*                        m_channels;
+    std::map<std::string, Channel*>  m_openChannels;
+    Channel*                         m_waitChannel;
+    bool                             m_isWaitingToSend;
+
+    // By name. The names are arena strings too, and lookups go by
+    // std::string_view, so only a new name allocates.
+    template <typename T>
+    using Names = std::pmr::map<std::pmr::string, T, std::less<>>;
+
+    Names<long double>  m_realVars;
+    Names<std::int64_t> m_intVars;
+    Names<SharedString> m_strVars;
+
+    static const std::size_t MAX_ARRAY_DIMENSIONS = 8;
+
+    // Elements are laid out row-major; an array dimensioned with DIM A(n)
+    // has n + 1 elements along that dimension. Real elements are long
+    // double, as real variables are, so storing a value in an array and
+    // reading it back changes nothing.
+    template <typename T>
+    struct Array
+    {
+        // Takes the allocator of the map it is created in.
+        typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+        explicit Array(const allocator_type& allocator)
+            : extents(allocator), elements(allocator)
+        {
+        }
+
+        Array(const Array& other, const allocator_type& allocator)
+            : extents(other.extents, allocator), elements(other.elements, allocator)
+        {
+        }
+
+        std::pmr::vector<std::size_t> extents;
+        std::pmr::vector<T>           elements;
+    };
+
+    // Arrays by name, and by the slot of their name (see
+    // Program::getName()) once an element reference has found them, so
+    // that the next one costs an index and the offset arithmetic alone.
+    // Arrays are never removed but all at once, which empties bySlot too.
+    template <typename T>
+    struct Arrays
+    {
+        explicit Arrays(std::pmr::memory_resource* resource)
+            : byName(resource), bySlot(resource)
+        {
+        }
+
+        // Gives the storage of bySlot back as well, before a rewind.
+        void release()
+        {
+            byName.clear();
+            std::pmr::vector<Array<T>*>(bySlot.get_allocator()).swap(bySlot);
+        }
+
+        Names<Array<T>>             byName;
+        std::pmr::vector<Array<T>*> bySlot;
+    };
+
+    Arrays<long double>  m_realArrays;
+    Arrays<std::int64_t> m_intArrays;
+    Arrays<SharedString> m_strArrays;
+
+    enum MatOperation
+    {
+        MAT_COPY,
+        MAT_ADD,
+        MAT_SUBTRACT,
+        MAT_MULTIPLY,
+        MAT_SCALE,
+        MAT_DOT,
+        MAT_SUM,
+        MAT_MIN,
+        MAT_MAX
+    };
+
+    // Return lines of the active GOSUBs, innermost last.
+    std::pmr::vector<std::size_t> m_callStack;
+
+    // Stack over a vector that can be emptied without giving its storage
+    // back.
+    template <typename T>
+    struct Stack : std::stack<T, std::pmr::vector<T>>
+    {
+        explicit Stack(std::pmr::memory_resource* resource)
+            : std::stack<T, std::pmr::vector<T>>(std::pmr::vector<T>(resource))
+        {
+        }
+
+        void clear() { this->c.clear(); }
+
+        // Empties the stack and gives its storage back as well.
+        void release() { std::pmr::vector<T>(this->c.get_allocator()).swap(this->c); }
+    };
+
+    struct Operation
+    {
+        Token::Value tokenValue;
+        std::size_t  totalOperands;
+        int          priority;
+        const Token* token;
+    };
+
+    // Argument list of a function called with parentheses.
+    struct Call
+    {
+        int         priorityBase;
+        std::size_t totalArguments;
+    };
+
+    // Working stacks of evaluate(), kept from one call to the next so that
+    // expressions on numbers allocate nothing once the run is warm. Truth
+    // values are kept as char, clear of std::vector<bool>.
+    Stack<Operation>    m_operations;
+    Stack<OperandType>  m_types;
+    Stack<long double>  m_reals;
+    Stack<std::int64_t> m_integers;
+    Stack<SharedString> m_strings;
+    Stack<char>         m_booleans;
+    Stack<Call>         m_calls;
+
+    // ELSE keywords of an IF line not yet matched, innermost last.
+    std::pmr::vector<std::size_t> m_elses;
+
+    void reset();
+
+    // The uppercased name of an identifier of the program.
+    const std::string& getName(const Token& id) const { return m_program.getName(id.getSlot()); }
+
+    // Gives the names the program has gained since a slot each.
+    void resizeSlots();
+
+    // What the run holds by the governor's reckoning: m_memoryBytes plus
+    // an estimate per variable and GOSUB.
+    std::size_t getMemoryUsage() const
+    {
+        static const std::size_t VARIABLE_BYTES = 64;
+
+        return m_memoryBytes + m_callStack.size() * sizeof(std::size_t) +
+            (m_realVars.size() + m_intVars.size() + m_strVars.size()) * VARIABLE_BYTES;
+    }
+
+    // Checks the limits before the line runs, and writes a checkpoint if
+    // one has been requested; one that cannot be written is reported and
+    // the run goes on.
+    Governor::Verdict govern(std::size_t line)
+    {
+        if (m_isCheckpointRequested.exchange(false, std::memory_order_relaxed))
+            checkpoint(line, m_checkpointFile);
+
+        if (m_isTraceRequested.exchange(false, std::memory_order_relaxed))
+            writeTrace();
+
+        if (nullptr != m_metrics)
+            publish();
+
+        return m_governor.check(getMemoryUsage(), m_err);
+    }
+
+    // Brings the gauges of m_metrics up to date.
+    void publish();
+
+    // Records a line that was run and the line it went on to.
+    void trace(std::size_t line, std::size_t next)
+    {
+        const VectorOfTokens& tokens = m_tokens[line];
+        m_trace.record(line, tokens.empty() ? Token::INVALID : tokens[0].getValue(), next);
+    }
+
+    void writeTrace()
+    {
+        if (m_traceFile.empty())
+            m_err << "No trace file!\n";
+        else
+            m_trace.write(m_traceFile, m_program, m_err);
+    }
+
+    // Writes a checkpoint that goes on at the line.
+    bool checkpoint(std::size_t line, const std::string& fileName);
+
+    void storeString(SharedString& target, SharedString&& value)
+    {
+        m_memoryBytes += value.size() - target.size();
+        target = std::move(value);
+        m_governor.charge(m_memoryBytes);
+    }
+
+    // Marks the statement being run as waiting; its caller gives up with
+    // SIZE_MAX.
+    std::size_t suspend(Status status)
+    {
+        m_status = status;
+        m_isSuspending = true;
+        return SIZE_MAX;
+    }
+
+    // Seeds RND, with the seed a replay recorded in its place if there is
+    // one, and moves it to the run's stream.
+    void seedRandom(std::uint64_t seed)
+    {
+        if (nullptr != m_replay)
+            m_replay->getSeed(seed);
+
+        if (nullptr != m_recorder)
+            m_recorder->putSeed(seed);
+
+        m_random.seed(seed);
+
+        for (std::uint64_t i = 0; i < m_stream; i++)
+            m_random.jump();
+    }
+
+    static std::uint64_t drawSeed()
+    {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) | device();
+    }
+
+    // The generator, once the state a resumable statement restarts from
+    // has been saved.
+    Random& random()
+    {
+        if (m_isResumable && !m_isRandomSaved)
+            m_savedRandom = m_random, m_isRandomSaved = true;
+        return m_random;
+    }
+
+    // SHELL, SHELL$, EXEC, EXEC$, SPAWN, WAIT and WAIT$. The argument is
+    // a command, or a SPAWN handle for WAIT and WAIT$.
+    bool call(
+        Token::Value       function,
+        const std::string& command,
+        std::int64_t       handle,
+        CallResult&        result);
+
+    CallResult performCall(
+        Token::Value       function,
+        const std::string& command,
+        std::int64_t       handle);
+
+    bool runPlain();
+    bool runProfiled();
+    bool runAllocationProfiled();
+    bool runSampled();
+    bool runMapped();
+
+    static std::size_t executeLine(void* context, std::size_t line);
+
+    bool dimension(std::size_t line, std::size_t begin, std::size_t end);
+
+    bool assignElement(std::size_t line, std::size_t begin, std::size_t end);
+
+    bool evaluateSubscripts(
+        std::size_t   line,
+        std::size_t   begin,
+        std::size_t   end,
+        std::int64_t* subscripts,
+        std::size_t&  totalSubscripts,
+        std::size_t&  close);
+
+    bool matrix(std::size_t line, std::size_t begin, std::size_t end);
+
+    Channel* findChannel(std::size_t line, std::size_t begin, std::size_t end);
+
+    bool send(std::size_t line, std::size_t begin, std::size_t end);
+    bool receive(std::size_t line, std::size_t begin, std::size_t end);
+
+    template <typename T>
+    bool matrixAssign(
+        Arrays<T>&   arrays,
+        MatOperation operation,
+        const Token& target,
+        const Token& a,
+        const Token* b,
+        T            factor);
+
+    template <typename T>
+    bool matrixReduce(
+        Arrays<T>&   arrays,
+        MatOperation operation,
+        const Token& a,
+        const Token* b,
+        T&           result);
+
+    // The array of the identifier, created without extents if need be.
+    template <typename T>
+    Array<T>& makeArray(Arrays<T>& arrays, const Token& id);
+
+    template <typename T>
+    Array<T>* findArray(Arrays<T>& arrays, const Token& id);
+
+    // Whether DIM or MAT has given the array of the identifier a shape.
+    template <typename T>
+    bool isDimensioned(Arrays<T>& arrays, const Token& id);
+
+    template <typename T>
+    T* element(
+        Arrays<T>&          arrays,
+        const Token&        id,
+        const std::int64_t* subscripts,
+        std::size_t         totalSubscripts);
+
+    std::size_t execute(
+        std::size_t line,
+        std::size_t begin,
+        std::size_t end);
+
+    bool evaluate(
+        VectorOfTokens::const_iterator begin,
+        VectorOfTokens::const_iterator end,
+        bool&                          boolResult,
+        std::string_view               varResult = "",
+        const OperandType              varType = OPERAND_TYPE_BOOLEAN,
+        OperandType*                   resultType = nullptr);
+};
+
+#endif // EXECUTION_HPP_INCLUDED
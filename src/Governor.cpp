@@ -0,0 +1,140 @@
+#include <algorithm>
+#include "Governor.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+Governor::Governor()
+    : m_timeSlice(0)
+    , m_countdown(CHECK_INTERVAL)
+    , m_armed(CHECK_INTERVAL)
+    , m_started(0)
+    , m_isPreempted(false)
+    , m_cpuTime(0)
+    , m_sliceCpuStart(0)
+{
+}
+
+
+double Governor::getThreadTime()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+
+    if (!::GetThreadTimes(::GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return 0;
+
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime, k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime, u.HighPart = user.dwHighDateTime;
+
+    return static_cast<double>(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+    timespec time;
+
+    if (0 != ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time))
+        return 0;
+
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+}
+
+
+// Also begins the first slice.
+void Governor::start()
+{
+    m_started = 0;
+    m_cpuTime = 0;
+    m_isPreempted.store(false, std::memory_order_relaxed);
+    m_startTime = Clock::now();
+
+    rearm();
+    enter();
+}
+
+
+void Governor::enter()
+{
+    if (0 != m_timeSlice)
+    {
+        m_sliceEnd = Clock::now() +
+            std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(m_timeSlice));
+    }
+
+    if (0 != m_limits.cpuSeconds)
+        m_sliceCpuStart = getThreadTime();
+}
+
+
+void Governor::leave()
+{
+    if (0 != m_limits.cpuSeconds)
+        m_cpuTime += getThreadTime() - m_sliceCpuStart;
+}
+
+
+// The countdown runs out as the statement it was last set to reach is
+// about to start, so the statement limit is hit before the first
+// statement too many runs.
+void Governor::rearm()
+{
+    std::uint64_t interval = CHECK_INTERVAL;
+
+    if (0 != m_limits.statements)
+    {
+        if (m_started <= m_limits.statements)
+            interval = std::min(interval, m_limits.statements + 1 - m_started);
+        else
+            interval = 1;
+    }
+
+    m_armed = m_countdown = static_cast<std::uint32_t>(interval);
+}
+
+
+Governor::Verdict Governor::check(std::size_t memory, std::ostream& err)
+{
+    m_started += m_armed;
+
+    Verdict verdict = VERDICT_STOP;
+
+    if ((0 != m_limits.statements) && (m_started > m_limits.statements))
+    {
+        err << "Statement limit exceeded!\n";
+    }
+    else if ((0 != m_limits.memoryBytes) && (memory > m_limits.memoryBytes))
+    {
+        err << "Memory limit exceeded!\n";
+    }
+    else if ((0 != m_limits.wallSeconds) &&
+        (std::chrono::duration<double>(Clock::now() - m_startTime).count() >=
+            m_limits.wallSeconds))
+    {
+        err << "Time limit exceeded!\n";
+    }
+    else if ((0 != m_limits.cpuSeconds) &&
+        (m_cpuTime + getThreadTime() - m_sliceCpuStart >= m_limits.cpuSeconds))
+    {
+        err << "CPU time limit exceeded!\n";
+    }
+    else if (m_isPreempted.exchange(false, std::memory_order_relaxed) ||
+        ((0 != m_timeSlice) && (Clock::now() >= m_sliceEnd)))
+    {
+        verdict = VERDICT_YIELD;
+    }
+    else
+    {
+        verdict = VERDICT_CONTINUE;
+    }
+
+    // The statement about to start does not when the run stops here.
+    if (VERDICT_CONTINUE != verdict)
+        m_started--;
+
+    rearm();
+    return verdict;
+}
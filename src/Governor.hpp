@@ -0,0 +1,103 @@
+#ifndef GOVERNOR_HPP_INCLUDED
+#define GOVERNOR_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Resource limits of one execution. The run loops count statements down
+// and only look at the clocks and the memory figure when the count runs
+// out, every CHECK_INTERVAL statements or sooner when a limit is near.
+class Governor
+{
+public:
+
+    // Zero means no limit.
+    struct Limits
+    {
+        Limits() : statements(0), wallSeconds(0), cpuSeconds(0), memoryBytes(0)
+        {
+        }
+
+        std::uint64_t statements;   // statements started
+        double        wallSeconds;  // real time since the run started
+        double        cpuSeconds;   // CPU time spent running it
+        std::size_t   memoryBytes;  // variables, arrays and string contents
+    };
+
+    enum Verdict
+    {
+        VERDICT_CONTINUE,
+        VERDICT_YIELD,
+        VERDICT_STOP
+    };
+
+    static const std::uint32_t CHECK_INTERVAL = 1024;
+
+    Governor();
+
+    void setLimits(const Limits& limits) { m_limits = limits; }
+    const Limits& getLimits() const { return m_limits; }
+
+    // A resumable run returns to the host after this much time in resume().
+    void setTimeSlice(double seconds) { m_timeSlice = seconds; }
+
+    // Asks a resumable run to return to the host at its next check, at
+    // most CHECK_INTERVAL statements later. Safe to call from any thread.
+    void preempt() { m_isPreempted.store(true, std::memory_order_relaxed); }
+
+    // A run starts; enter() and leave() bracket each slice of a resumable
+    // run, run() being a single slice.
+    void start();
+    void enter();
+    void leave();
+
+    // Called before every statement; true when check() is due.
+    bool tick() { return 0 == --m_countdown; }
+
+    // Makes the next statement check when memory has grown past the limit.
+    void charge(std::size_t memory)
+    {
+        if ((0 != m_limits.memoryBytes) && (memory > m_limits.memoryBytes))
+            expire();
+    }
+
+    // Reports a limit that has been hit to err.
+    Verdict check(std::size_t memory, std::ostream& err);
+
+    std::uint64_t getTotalStatements() const
+    {
+        return m_started + (m_armed - m_countdown);
+    }
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    static double getThreadTime();
+
+    void expire()
+    {
+        m_armed -= m_countdown - 1;
+        m_countdown = 1;
+    }
+
+    void rearm();
+
+    Limits m_limits;
+    double m_timeSlice;
+
+    std::uint32_t     m_countdown;
+    std::uint32_t     m_armed;      // what the countdown was set to
+    std::uint64_t     m_started;    // statements before the countdown
+    std::atomic<bool> m_isPreempted;
+
+    Clock::time_point m_startTime;
+    Clock::time_point m_sliceEnd;
+    double            m_cpuTime;
+    double            m_sliceCpuStart;
+};
+
+#endif // GOVERNOR_HPP_INCLUDED
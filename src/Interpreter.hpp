@@ -1,59 +1,72 @@
 #ifndef INTERPRETER_HPP_INCLUDED
 #define INTERPRETER_HPP_INCLUDED
 
-#include <cstdint>
-#include <memory>
-#include <map>
-#include <stack>
-#include <vector>
-#include <string>
 #include <iostream>
-#include "Token.hpp"
+#include "Execution.hpp"
+#include "Program.hpp"
 
+// A program together with one execution of it, for the common case of
+// loading a file and running it once. Hosts that run one program many
+// times load a Program and create an Execution per run instead.
 class Interpreter
 {
 public:
 
-    enum OperandType
+    explicit Interpreter(
+        std::istream& in  = std::cin,
+        std::ostream& out = std::cout,
+        std::ostream& err = std::cerr)
+        : m_err(err)
+        , m_execution(m_program, in, out, err)
     {
-        OPERAND_TYPE_REAL,
-        OPERAND_TYPE_INTEGER,
-        OPERAND_TYPE_STRING,
-        OPERAND_TYPE_BOOLEAN
-    };
+    }
 
-    bool load(std::istream& file);
-    bool run();
+    bool load(std::istream& file) { return m_program.load(file, m_err); }
+    bool run() { return m_execution.run(); }
+
+    void setSeed(std::uint64_t seed) { m_execution.setSeed(seed); }
+    void setStream(std::uint64_t stream) { m_execution.setStream(stream); }
+    void setLimits(const Governor::Limits& limits) { m_execution.setLimits(limits); }
+
+    void setProfiler(Profiler* profiler) { m_execution.setProfiler(profiler); }
+    void setSampler(Sampler* sampler) { m_execution.setSampler(sampler); }
+    void setPerfMap(PerfMap* perfMap) { m_execution.setPerfMap(perfMap); }
+    void setAllocationProfiler(AllocationProfiler* profiler) { m_execution.setAllocationProfiler(profiler); }
+
+    void setChannels(Channels* channels) { m_execution.setChannels(channels); }
+
+    void setRecorder(Recording* recorder) { m_execution.setRecorder(recorder); }
+    void setReplay(Recording* replay) { m_execution.setReplay(replay); }
+
+    // Counting into getMetrics() is off until enabled, as it costs a
+    // little on every statement.
+    void enableMetrics(bool isEnabled = true)
+    {
+        m_execution.setMetrics(isEnabled ? &m_metrics : nullptr);
+    }
+
+    Metrics& getMetrics() { return m_metrics; }
+
+    void setCheckpointFile(const std::string& fileName) { m_execution.setCheckpointFile(fileName); }
+    void requestCheckpoint() { m_execution.requestCheckpoint(); }
+
+    void setTraceFile(const std::string& fileName) { m_execution.setTraceFile(fileName); }
+    void requestTrace() { m_execution.requestTrace(); }
+
+    // After load(); run() then goes on from the checkpoint.
+    bool restore(std::istream& file) { return m_execution.restore(file); }
+
+    const Program& getProgram() const { return m_program; }
 
 private:
 
-    typedef std::vector<Token>    VectorOfTokens;
-    typedef std::unique_ptr<char> SourceLine;
-    
-    std::vector<VectorOfTokens> m_tokens;
-    std::vector<SourceLine>     m_source;
-
-    std::map<std::string, std::size_t> m_labels;
-    
-    std::map<std::string, long double>  m_realVars;
-    std::map<std::string, std::int64_t> m_intVars;
-    std::map<std::string, std::string>  m_strVars;
-
-    std::stack<std::size_t> m_callStack;
-
-    bool registerLabel(const Token& token);
-
-    std::size_t execute(
-        std::size_t line,
-        std::size_t begin,
-        std::size_t end);
-
-    bool Interpreter::evaluate(
-        VectorOfTokens::iterator& begin,
-        VectorOfTokens::iterator  end,
-        bool&                     boolResult,
-        const std::string&        varResult = "",
-        const OperandType         varType = OPERAND_TYPE_BOOLEAN);
+    Interpreter(const Interpreter&);
+    Interpreter& operator =(const Interpreter&);
+
+    std::ostream& m_err;
+    Program       m_program;
+    Metrics       m_metrics;
+    Execution     m_execution;
 };
 
 #endif // INTERPRETER_HPP_INCLUDED
@@ -0,0 +1,148 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#endif
+{
+}
+
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+
+    m_file = ::CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (INVALID_HANDLE_VALUE == m_file)
+        return false;
+
+    LARGE_INTEGER size;
+
+    if (!::GetFileSizeEx(m_file, &size))
+    {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped, and need not be.
+    if (0 == m_size)
+        return true;
+
+    m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (nullptr == m_mapping)
+    {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const char*>(
+        ::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (nullptr == m_data)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void MappedFile::close()
+{
+    if (nullptr != m_data)
+        ::UnmapViewOfFile(m_data);
+
+    if (nullptr != m_mapping)
+        ::CloseHandle(m_mapping);
+
+    if (INVALID_HANDLE_VALUE != m_file)
+        ::CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+
+    int file = ::open(fileName.c_str(), O_RDONLY);
+
+    if (-1 == file)
+        return false;
+
+    struct stat status;
+
+    if (0 != ::fstat(file, &status))
+    {
+        ::close(file);
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(status.st_size);
+
+    // Empty files cannot be mapped, and need not be.
+    if (0 == m_size)
+    {
+        ::close(file);
+        return true;
+    }
+
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps the file alive.
+    ::close(file);
+
+    if (MAP_FAILED == data)
+    {
+        m_size = 0;
+        return false;
+    }
+
+    ::madvise(data, m_size, MADV_SEQUENTIAL);
+
+    m_data = static_cast<const char*>(data);
+    return true;
+}
+
+
+void MappedFile::close()
+{
+    if (nullptr != m_data)
+        ::munmap(const_cast<char*>(m_data), m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_HPP_INCLUDED
+#define MAPPED_FILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file mapped into memory.
+class MappedFile
+{
+public:
+
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string& fileName);
+    void close();
+
+    const char* getData() const { return m_data; }
+    std::size_t getSize() const { return m_size; }
+
+private:
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator =(const MappedFile&);
+
+    const char* m_data;
+    std::size_t m_size;
+
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP_INCLUDED
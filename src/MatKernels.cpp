@@ -0,0 +1,955 @@
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include "MatKernels.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MAT_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(MAT_KERNELS_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#define MAT_KERNELS_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AVX2_FUNCTION
+#else
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    // Integer kernels wrap around on overflow at every level, so the scalar
+    // versions compute in unsigned arithmetic to match the vector ones.
+    inline std::int64_t wrappingAdd(std::int64_t a, std::int64_t b)
+    {
+        return static_cast<std::int64_t>(
+            static_cast<std::uint64_t>(a) + static_cast<std::uint64_t>(b));
+    }
+
+    inline std::int64_t wrappingSubtract(std::int64_t a, std::int64_t b)
+    {
+        return static_cast<std::int64_t>(
+            static_cast<std::uint64_t>(a) - static_cast<std::uint64_t>(b));
+    }
+
+    inline std::int64_t wrappingMultiply(std::int64_t a, std::int64_t b)
+    {
+        return static_cast<std::int64_t>(
+            static_cast<std::uint64_t>(a) * static_cast<std::uint64_t>(b));
+    }
+
+    // Scalar kernels //////////////////////////////////////////////////////
+
+    void addRealScalar(double* c, const double* a, const double* b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            c[i] = a[i] + b[i];
+    }
+
+    void subtractRealScalar(double* c, const double* a, const double* b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            c[i] = a[i] - b[i];
+    }
+
+    void scaleRealScalar(double* c, const double* a, double k, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            c[i] = a[i] * k;
+    }
+
+    double dotRealScalar(const double* a, const double* b, std::size_t n)
+    {
+        double result = 0;
+        for (std::size_t i = 0; i < n; i++)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    double sumRealScalar(const double* a, std::size_t n)
+    {
+        double result = 0;
+        for (std::size_t i = 0; i < n; i++)
+            result += a[i];
+        return result;
+    }
+
+    double minRealScalar(const double* a, std::size_t n)
+    {
+        double result = a[0];
+        for (std::size_t i = 1; i < n; i++)
+            result = std::min(result, a[i]);
+        return result;
+    }
+
+    double maxRealScalar(const double* a, std::size_t n)
+    {
+        double result = a[0];
+        for (std::size_t i = 1; i < n; i++)
+            result = std::max(result, a[i]);
+        return result;
+    }
+
+    // Rows of c are accumulated as a[i][k] * b[k][...], which keeps the
+    // inner loop contiguous; the vector versions use the same order and
+    // therefore give bit-identical products.
+    void multiplyRealScalar(
+        double*       c,
+        const double* a,
+        const double* b,
+        std::size_t   rows,
+        std::size_t   inner,
+        std::size_t   columns)
+    {
+        for (std::size_t i = 0; i < rows; i++)
+        {
+            double* row = c + i * columns;
+            std::fill(row, row + columns, 0.0);
+
+            for (std::size_t k = 0; k < inner; k++)
+            {
+                const double  factor = a[i * inner + k];
+                const double* source = b + k * columns;
+
+                for (std::size_t j = 0; j < columns; j++)
+                    row[j] += factor * source[j];
+            }
+        }
+    }
+
+    void addIntegerScalar(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            c[i] = wrappingAdd(a[i], b[i]);
+    }
+
+    void subtractIntegerScalar(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            c[i] = wrappingSubtract(a[i], b[i]);
+    }
+
+    std::int64_t sumIntegerScalar(const std::int64_t* a, std::size_t n)
+    {
+        std::int64_t result = 0;
+        for (std::size_t i = 0; i < n; i++)
+            result = wrappingAdd(result, a[i]);
+        return result;
+    }
+
+    std::int64_t minIntegerScalar(const std::int64_t* a, std::size_t n)
+    {
+        std::int64_t result = a[0];
+        for (std::size_t i = 1; i < n; i++)
+            result = std::min(result, a[i]);
+        return result;
+    }
+
+    std::int64_t maxIntegerScalar(const std::int64_t* a, std::size_t n)
+    {
+        std::int64_t result = a[0];
+        for (std::size_t i = 1; i < n; i++)
+            result = std::max(result, a[i]);
+        return result;
+    }
+
+    const MatKernels::Table SCALAR =
+    {
+        addRealScalar,
+        subtractRealScalar,
+        scaleRealScalar,
+        dotRealScalar,
+        sumRealScalar,
+        minRealScalar,
+        maxRealScalar,
+        multiplyRealScalar,
+        addIntegerScalar,
+        subtractIntegerScalar,
+        sumIntegerScalar,
+        minIntegerScalar,
+        maxIntegerScalar
+    };
+
+#if defined(MAT_KERNELS_SSE2)
+
+    // SSE2 kernels ////////////////////////////////////////////////////////
+
+    void addRealSse2(double* c, const double* a, const double* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            _mm_storeu_pd(c + i,
+                _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        for (; i < n; i++)
+            c[i] = a[i] + b[i];
+    }
+
+    void subtractRealSse2(double* c, const double* a, const double* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            _mm_storeu_pd(c + i,
+                _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        for (; i < n; i++)
+            c[i] = a[i] - b[i];
+    }
+
+    void scaleRealSse2(double* c, const double* a, double k, std::size_t n)
+    {
+        const __m128d factor = _mm_set1_pd(k);
+
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            _mm_storeu_pd(c + i, _mm_mul_pd(_mm_loadu_pd(a + i), factor));
+        for (; i < n; i++)
+            c[i] = a[i] * k;
+    }
+
+    double horizontalSum(__m128d v)
+    {
+        return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+    }
+
+    double dotRealSse2(const double* a, const double* b, std::size_t n)
+    {
+        __m128d accumulator = _mm_setzero_pd();
+
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            accumulator = _mm_add_pd(accumulator,
+                _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+
+        double result = horizontalSum(accumulator);
+        for (; i < n; i++)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    double sumRealSse2(const double* a, std::size_t n)
+    {
+        __m128d accumulator = _mm_setzero_pd();
+
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            accumulator = _mm_add_pd(accumulator, _mm_loadu_pd(a + i));
+
+        double result = horizontalSum(accumulator);
+        for (; i < n; i++)
+            result += a[i];
+        return result;
+    }
+
+    double minRealSse2(const double* a, std::size_t n)
+    {
+        if (n < 2)
+            return a[0];
+
+        __m128d accumulator = _mm_loadu_pd(a);
+
+        std::size_t i = 2;
+        for (; i + 2 <= n; i += 2)
+            accumulator = _mm_min_pd(accumulator, _mm_loadu_pd(a + i));
+
+        accumulator = _mm_min_sd(accumulator,
+            _mm_unpackhi_pd(accumulator, accumulator));
+
+        double result = _mm_cvtsd_f64(accumulator);
+        for (; i < n; i++)
+            result = std::min(result, a[i]);
+        return result;
+    }
+
+    double maxRealSse2(const double* a, std::size_t n)
+    {
+        if (n < 2)
+            return a[0];
+
+        __m128d accumulator = _mm_loadu_pd(a);
+
+        std::size_t i = 2;
+        for (; i + 2 <= n; i += 2)
+            accumulator = _mm_max_pd(accumulator, _mm_loadu_pd(a + i));
+
+        accumulator = _mm_max_sd(accumulator,
+            _mm_unpackhi_pd(accumulator, accumulator));
+
+        double result = _mm_cvtsd_f64(accumulator);
+        for (; i < n; i++)
+            result = std::max(result, a[i]);
+        return result;
+    }
+
+    void multiplyRealSse2(
+        double*       c,
+        const double* a,
+        const double* b,
+        std::size_t   rows,
+        std::size_t   inner,
+        std::size_t   columns)
+    {
+        for (std::size_t i = 0; i < rows; i++)
+        {
+            double* row = c + i * columns;
+            std::fill(row, row + columns, 0.0);
+
+            for (std::size_t k = 0; k < inner; k++)
+            {
+                const double  factor = a[i * inner + k];
+                const double* source = b + k * columns;
+                const __m128d f = _mm_set1_pd(factor);
+
+                std::size_t j = 0;
+                for (; j + 2 <= columns; j += 2)
+                    _mm_storeu_pd(row + j, _mm_add_pd(_mm_loadu_pd(row + j),
+                        _mm_mul_pd(f, _mm_loadu_pd(source + j))));
+                for (; j < columns; j++)
+                    row[j] += factor * source[j];
+            }
+        }
+    }
+
+    void addIntegerSse2(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(c + i),
+                _mm_add_epi64(va, vb));
+        }
+        for (; i < n; i++)
+            c[i] = wrappingAdd(a[i], b[i]);
+    }
+
+    void subtractIntegerSse2(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(c + i),
+                _mm_sub_epi64(va, vb));
+        }
+        for (; i < n; i++)
+            c[i] = wrappingSubtract(a[i], b[i]);
+    }
+
+    std::int64_t sumIntegerSse2(const std::int64_t* a, std::size_t n)
+    {
+        __m128i accumulator = _mm_setzero_si128();
+
+        std::size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            accumulator = _mm_add_epi64(accumulator,
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+
+        std::int64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), accumulator);
+
+        std::int64_t result = wrappingAdd(lanes[0], lanes[1]);
+        for (; i < n; i++)
+            result = wrappingAdd(result, a[i]);
+        return result;
+    }
+
+    const MatKernels::Table SSE2 =
+    {
+        addRealSse2,
+        subtractRealSse2,
+        scaleRealSse2,
+        dotRealSse2,
+        sumRealSse2,
+        minRealSse2,
+        maxRealSse2,
+        multiplyRealSse2,
+        addIntegerSse2,
+        subtractIntegerSse2,
+        sumIntegerSse2,
+        minIntegerScalar,
+        maxIntegerScalar
+    };
+
+#endif // MAT_KERNELS_SSE2
+
+#if defined(MAT_KERNELS_AVX2)
+
+    // AVX2 kernels ////////////////////////////////////////////////////////
+
+    AVX2_FUNCTION
+    void addRealAvx2(double* c, const double* a, const double* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_pd(c + i,
+                _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        for (; i < n; i++)
+            c[i] = a[i] + b[i];
+    }
+
+    AVX2_FUNCTION
+    void subtractRealAvx2(double* c, const double* a, const double* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_pd(c + i,
+                _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        for (; i < n; i++)
+            c[i] = a[i] - b[i];
+    }
+
+    AVX2_FUNCTION
+    void scaleRealAvx2(double* c, const double* a, double k, std::size_t n)
+    {
+        const __m256d factor = _mm256_set1_pd(k);
+
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_pd(c + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+        for (; i < n; i++)
+            c[i] = a[i] * k;
+    }
+
+    AVX2_FUNCTION
+    double horizontalSum(__m256d v)
+    {
+        __m128d half = _mm_add_pd(
+            _mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    AVX2_FUNCTION
+    double dotRealAvx2(const double* a, const double* b, std::size_t n)
+    {
+        __m256d accumulator = _mm256_setzero_pd();
+
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            accumulator = _mm256_add_pd(accumulator,
+                _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+
+        double result = horizontalSum(accumulator);
+        for (; i < n; i++)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    AVX2_FUNCTION
+    double sumRealAvx2(const double* a, std::size_t n)
+    {
+        __m256d accumulator = _mm256_setzero_pd();
+
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            accumulator = _mm256_add_pd(accumulator, _mm256_loadu_pd(a + i));
+
+        double result = horizontalSum(accumulator);
+        for (; i < n; i++)
+            result += a[i];
+        return result;
+    }
+
+    AVX2_FUNCTION
+    double minRealAvx2(const double* a, std::size_t n)
+    {
+        if (n < 4)
+            return minRealScalar(a, n);
+
+        __m256d accumulator = _mm256_loadu_pd(a);
+
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4)
+            accumulator = _mm256_min_pd(accumulator, _mm256_loadu_pd(a + i));
+
+        double lanes[4];
+        _mm256_storeu_pd(lanes, accumulator);
+
+        double result = minRealScalar(lanes, 4);
+        for (; i < n; i++)
+            result = std::min(result, a[i]);
+        return result;
+    }
+
+    AVX2_FUNCTION
+    double maxRealAvx2(const double* a, std::size_t n)
+    {
+        if (n < 4)
+            return maxRealScalar(a, n);
+
+        __m256d accumulator = _mm256_loadu_pd(a);
+
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4)
+            accumulator = _mm256_max_pd(accumulator, _mm256_loadu_pd(a + i));
+
+        double lanes[4];
+        _mm256_storeu_pd(lanes, accumulator);
+
+        double result = maxRealScalar(lanes, 4);
+        for (; i < n; i++)
+            result = std::max(result, a[i]);
+        return result;
+    }
+
+    AVX2_FUNCTION
+    void multiplyRealAvx2(
+        double*       c,
+        const double* a,
+        const double* b,
+        std::size_t   rows,
+        std::size_t   inner,
+        std::size_t   columns)
+    {
+        for (std::size_t i = 0; i < rows; i++)
+        {
+            double* row = c + i * columns;
+            std::fill(row, row + columns, 0.0);
+
+            for (std::size_t k = 0; k < inner; k++)
+            {
+                const double  factor = a[i * inner + k];
+                const double* source = b + k * columns;
+                const __m256d f = _mm256_set1_pd(factor);
+
+                std::size_t j = 0;
+                for (; j + 4 <= columns; j += 4)
+                    _mm256_storeu_pd(row + j, _mm256_add_pd(
+                        _mm256_loadu_pd(row + j),
+                        _mm256_mul_pd(f, _mm256_loadu_pd(source + j))));
+                for (; j < columns; j++)
+                    row[j] += factor * source[j];
+            }
+        }
+    }
+
+    AVX2_FUNCTION
+    void addIntegerAvx2(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i),
+                _mm256_add_epi64(va, vb));
+        }
+        for (; i < n; i++)
+            c[i] = wrappingAdd(a[i], b[i]);
+    }
+
+    AVX2_FUNCTION
+    void subtractIntegerAvx2(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i),
+                _mm256_sub_epi64(va, vb));
+        }
+        for (; i < n; i++)
+            c[i] = wrappingSubtract(a[i], b[i]);
+    }
+
+    AVX2_FUNCTION
+    std::int64_t sumIntegerAvx2(const std::int64_t* a, std::size_t n)
+    {
+        __m256i accumulator = _mm256_setzero_si256();
+
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            accumulator = _mm256_add_epi64(accumulator,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+
+        std::int64_t lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), accumulator);
+
+        std::int64_t result = sumIntegerScalar(lanes, 4);
+        for (; i < n; i++)
+            result = wrappingAdd(result, a[i]);
+        return result;
+    }
+
+    AVX2_FUNCTION
+    std::int64_t minIntegerAvx2(const std::int64_t* a, std::size_t n)
+    {
+        if (n < 4)
+            return minIntegerScalar(a, n);
+
+        __m256i accumulator =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            accumulator = _mm256_blendv_epi8(accumulator, v,
+                _mm256_cmpgt_epi64(accumulator, v));
+        }
+
+        std::int64_t lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), accumulator);
+
+        std::int64_t result = minIntegerScalar(lanes, 4);
+        for (; i < n; i++)
+            result = std::min(result, a[i]);
+        return result;
+    }
+
+    AVX2_FUNCTION
+    std::int64_t maxIntegerAvx2(const std::int64_t* a, std::size_t n)
+    {
+        if (n < 4)
+            return maxIntegerScalar(a, n);
+
+        __m256i accumulator =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            accumulator = _mm256_blendv_epi8(accumulator, v,
+                _mm256_cmpgt_epi64(v, accumulator));
+        }
+
+        std::int64_t lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), accumulator);
+
+        std::int64_t result = maxIntegerScalar(lanes, 4);
+        for (; i < n; i++)
+            result = std::max(result, a[i]);
+        return result;
+    }
+
+    const MatKernels::Table AVX2 =
+    {
+        addRealAvx2,
+        subtractRealAvx2,
+        scaleRealAvx2,
+        dotRealAvx2,
+        sumRealAvx2,
+        minRealAvx2,
+        maxRealAvx2,
+        multiplyRealAvx2,
+        addIntegerAvx2,
+        subtractIntegerAvx2,
+        sumIntegerAvx2,
+        minIntegerAvx2,
+        maxIntegerAvx2
+    };
+
+#endif // MAT_KERNELS_AVX2
+}
+
+
+MatKernels::Level MatKernels::detect()
+{
+    Level level = LEVEL_SCALAR;
+
+#if defined(MAT_KERNELS_SSE2)
+    level = LEVEL_SSE2;
+#endif
+
+#if defined(MAT_KERNELS_AVX2)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] >= 7)
+    {
+        __cpuid(info, 1);
+
+        const bool osxsave = 0 != (info[2] & (1 << 27));
+        const bool avx     = 0 != (info[2] & (1 << 28));
+
+        if (osxsave && avx && (6 == (_xgetbv(0) & 6)))
+        {
+            __cpuidex(info, 7, 0);
+
+            if (0 != (info[1] & (1 << 5)))
+                level = LEVEL_AVX2;
+        }
+    }
+#else
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        level = LEVEL_AVX2;
+#endif
+#endif
+
+    // Lets benchmarks pin a narrower level than the CPU offers.
+    if (const char* forced = std::getenv("CITBASIC_SIMD"))
+    {
+        for (int i = LEVEL_SCALAR; i < level; i++)
+        {
+            if (0 == std::strcmp(forced, name(static_cast<Level>(i))))
+                level = static_cast<Level>(i);
+        }
+    }
+
+    return level;
+}
+
+
+const MatKernels::Table& MatKernels::table(Level level)
+{
+#if defined(MAT_KERNELS_AVX2)
+    if (LEVEL_AVX2 <= level)
+        return AVX2;
+#endif
+
+#if defined(MAT_KERNELS_SSE2)
+    if (LEVEL_SSE2 <= level)
+        return SSE2;
+#endif
+
+    return SCALAR;
+}
+
+
+const char* MatKernels::name(Level level)
+{
+    switch (level)
+    {
+    case LEVEL_SSE2:
+        return "sse2";
+
+    case LEVEL_AVX2:
+        return "avx2";
+
+    default:
+        return "scalar";
+    }
+}
+
+
+void MatKernels::scale(
+    std::int64_t*       c,
+    const std::int64_t* a,
+    std::int64_t        k,
+    std::size_t         n)
+{
+    for (std::size_t i = 0; i < n; i++)
+        c[i] = wrappingMultiply(a[i], k);
+}
+
+
+std::int64_t MatKernels::dot(
+    const std::int64_t* a,
+    const std::int64_t* b,
+    std::size_t         n)
+{
+    std::int64_t result = 0;
+    for (std::size_t i = 0; i < n; i++)
+        result = wrappingAdd(result, wrappingMultiply(a[i], b[i]));
+    return result;
+}
+
+
+void MatKernels::multiply(
+    std::int64_t*       c,
+    const std::int64_t* a,
+    const std::int64_t* b,
+    std::size_t         rows,
+    std::size_t         inner,
+    std::size_t         columns)
+{
+    for (std::size_t i = 0; i < rows; i++)
+    {
+        std::int64_t* row = c + i * columns;
+        std::fill(row, row + columns, 0);
+
+        for (std::size_t k = 0; k < inner; k++)
+        {
+            const std::int64_t  factor = a[i * inner + k];
+            const std::int64_t* source = b + k * columns;
+
+            for (std::size_t j = 0; j < columns; j++)
+                row[j] = wrappingAdd(row[j], wrappingMultiply(factor, source[j]));
+        }
+    }
+}
+
+
+namespace
+{
+    // Elements converted at a time, on the stack.
+    const std::size_t BLOCK = 256;
+
+    inline void narrow(double* to, const long double* from, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            to[i] = static_cast<double>(from[i]);
+    }
+
+    inline void widen(long double* to, const double* from, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            to[i] = from[i];
+    }
+}
+
+
+void MatKernels::add(
+    long double*       c,
+    const long double* a,
+    const long double* b,
+    std::size_t        n)
+{
+    double x[BLOCK];
+    double y[BLOCK];
+
+    for (std::size_t i = 0; i < n; i += BLOCK)
+    {
+        const std::size_t m = std::min(BLOCK, n - i);
+
+        narrow(x, a + i, m);
+        narrow(y, b + i, m);
+        table().addReal(x, x, y, m);
+        widen(c + i, x, m);
+    }
+}
+
+
+void MatKernels::subtract(
+    long double*       c,
+    const long double* a,
+    const long double* b,
+    std::size_t        n)
+{
+    double x[BLOCK];
+    double y[BLOCK];
+
+    for (std::size_t i = 0; i < n; i += BLOCK)
+    {
+        const std::size_t m = std::min(BLOCK, n - i);
+
+        narrow(x, a + i, m);
+        narrow(y, b + i, m);
+        table().subtractReal(x, x, y, m);
+        widen(c + i, x, m);
+    }
+}
+
+
+void MatKernels::scale(
+    long double*       c,
+    const long double* a,
+    long double        k,
+    std::size_t        n)
+{
+    double x[BLOCK];
+
+    for (std::size_t i = 0; i < n; i += BLOCK)
+    {
+        const std::size_t m = std::min(BLOCK, n - i);
+
+        narrow(x, a + i, m);
+        table().scaleReal(x, x, static_cast<double>(k), m);
+        widen(c + i, x, m);
+    }
+}
+
+
+long double MatKernels::dot(
+    const long double* a,
+    const long double* b,
+    std::size_t        n)
+{
+    double x[BLOCK];
+    double y[BLOCK];
+    double result = 0;
+
+    for (std::size_t i = 0; i < n; i += BLOCK)
+    {
+        const std::size_t m = std::min(BLOCK, n - i);
+
+        narrow(x, a + i, m);
+        narrow(y, b + i, m);
+        result += table().dotReal(x, y, m);
+    }
+
+    return result;
+}
+
+
+long double MatKernels::sum(const long double* a, std::size_t n)
+{
+    double x[BLOCK];
+    double result = 0;
+
+    for (std::size_t i = 0; i < n; i += BLOCK)
+    {
+        const std::size_t m = std::min(BLOCK, n - i);
+
+        narrow(x, a + i, m);
+        result += table().sumReal(x, m);
+    }
+
+    return result;
+}
+
+
+// Like the real kernels, these need at least one element.
+long double MatKernels::min(const long double* a, std::size_t n)
+{
+    double x[BLOCK];
+    double result = static_cast<double>(a[0]);
+
+    for (std::size_t i = 0; i < n; i += BLOCK)
+    {
+        const std::size_t m = std::min(BLOCK, n - i);
+
+        narrow(x, a + i, m);
+        result = std::min(result, table().minReal(x, m));
+    }
+
+    return result;
+}
+
+
+long double MatKernels::max(const long double* a, std::size_t n)
+{
+    double x[BLOCK];
+    double result = static_cast<double>(a[0]);
+
+    for (std::size_t i = 0; i < n; i += BLOCK)
+    {
+        const std::size_t m = std::min(BLOCK, n - i);
+
+        narrow(x, a + i, m);
+        result = std::max(result, table().maxReal(x, m));
+    }
+
+    return result;
+}
+
+
+// Every element of a and b is used many times over, so both are converted
+// whole.
+void MatKernels::multiply(
+    long double*       c,
+    const long double* a,
+    const long double* b,
+    std::size_t        rows,
+    std::size_t        inner,
+    std::size_t        columns)
+{
+    std::vector<double> x(rows * inner);
+    std::vector<double> y(inner * columns);
+    std::vector<double> z(rows * columns);
+
+    narrow(x.data(), a, x.size());
+    narrow(y.data(), b, y.size());
+    table().multiplyReal(z.data(), x.data(), y.data(), rows, inner, columns);
+    widen(c, z.data(), z.size());
+}
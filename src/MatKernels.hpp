@@ -0,0 +1,170 @@
+#ifndef MAT_KERNELS_HPP_INCLUDED
+#define MAT_KERNELS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+// Bulk arithmetic on contiguous numeric arrays, used by the MAT statement.
+//
+// Every kernel exists in a scalar version and, on x86, in SSE2 and AVX2
+// versions. The widest level the CPU supports is picked once, on first use.
+// Vectorized sums add the elements in a different order than the scalar
+// loop, so real reductions may differ in the last bits.
+class MatKernels
+{
+public:
+
+    enum Level
+    {
+        LEVEL_SCALAR,
+        LEVEL_SSE2,
+        LEVEL_AVX2
+    };
+
+    struct Table
+    {
+        void   (*addReal)(double* c, const double* a, const double* b, std::size_t n);
+        void   (*subtractReal)(double* c, const double* a, const double* b, std::size_t n);
+        void   (*scaleReal)(double* c, const double* a, double k, std::size_t n);
+        double (*dotReal)(const double* a, const double* b, std::size_t n);
+        double (*sumReal)(const double* a, std::size_t n);
+        double (*minReal)(const double* a, std::size_t n);
+        double (*maxReal)(const double* a, std::size_t n);
+
+        // c[rows x columns] = a[rows x inner] * b[inner x columns]
+        void   (*multiplyReal)(
+            double*       c,
+            const double* a,
+            const double* b,
+            std::size_t   rows,
+            std::size_t   inner,
+            std::size_t   columns);
+
+        void         (*addInteger)(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n);
+        void         (*subtractInteger)(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n);
+        std::int64_t (*sumInteger)(const std::int64_t* a, std::size_t n);
+        std::int64_t (*minInteger)(const std::int64_t* a, std::size_t n);
+        std::int64_t (*maxInteger)(const std::int64_t* a, std::size_t n);
+    };
+
+    // Best level supported by this CPU and build.
+    static Level detect();
+
+    // Kernels of the given level; levels the build lacks fall back to the
+    // widest one below them.
+    static const Table& table(Level level);
+
+    static const Table& table()
+    {
+        static const Table& selected = table(detect());
+        return selected;
+    }
+
+    static const char* name(Level level);
+
+    static void add(double* c, const double* a, const double* b, std::size_t n)
+    {
+        table().addReal(c, a, b, n);
+    }
+
+    static void subtract(double* c, const double* a, const double* b, std::size_t n)
+    {
+        table().subtractReal(c, a, b, n);
+    }
+
+    static void scale(double* c, const double* a, double k, std::size_t n)
+    {
+        table().scaleReal(c, a, k, n);
+    }
+
+    static double dot(const double* a, const double* b, std::size_t n)
+    {
+        return table().dotReal(a, b, n);
+    }
+
+    static double sum(const double* a, std::size_t n)
+    {
+        return table().sumReal(a, n);
+    }
+
+    static double min(const double* a, std::size_t n)
+    {
+        return table().minReal(a, n);
+    }
+
+    static double max(const double* a, std::size_t n)
+    {
+        return table().maxReal(a, n);
+    }
+
+    static void multiply(
+        double*       c,
+        const double* a,
+        const double* b,
+        std::size_t   rows,
+        std::size_t   inner,
+        std::size_t   columns)
+    {
+        table().multiplyReal(c, a, b, rows, inner, columns);
+    }
+
+    static void add(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        table().addInteger(c, a, b, n);
+    }
+
+    static void subtract(std::int64_t* c, const std::int64_t* a, const std::int64_t* b, std::size_t n)
+    {
+        table().subtractInteger(c, a, b, n);
+    }
+
+    static std::int64_t sum(const std::int64_t* a, std::size_t n)
+    {
+        return table().sumInteger(a, n);
+    }
+
+    static std::int64_t min(const std::int64_t* a, std::size_t n)
+    {
+        return table().minInteger(a, n);
+    }
+
+    static std::int64_t max(const std::int64_t* a, std::size_t n)
+    {
+        return table().maxInteger(a, n);
+    }
+
+    // There are no 64-bit integer multiplies below AVX-512, so these stay
+    // scalar on every level.
+    static void scale(std::int64_t* c, const std::int64_t* a, std::int64_t k, std::size_t n);
+
+    static std::int64_t dot(const std::int64_t* a, const std::int64_t* b, std::size_t n);
+
+    static void multiply(
+        std::int64_t*       c,
+        const std::int64_t* a,
+        const std::int64_t* b,
+        std::size_t         rows,
+        std::size_t         inner,
+        std::size_t         columns);
+
+    // Real arrays of BASIC hold long double, as its real variables do.
+    // These convert them to double a block at a time and run the real
+    // kernels above, so their results are rounded to double.
+    static void add(long double* c, const long double* a, const long double* b, std::size_t n);
+    static void subtract(long double* c, const long double* a, const long double* b, std::size_t n);
+    static void scale(long double* c, const long double* a, long double k, std::size_t n);
+    static long double dot(const long double* a, const long double* b, std::size_t n);
+    static long double sum(const long double* a, std::size_t n);
+    static long double min(const long double* a, std::size_t n);
+    static long double max(const long double* a, std::size_t n);
+
+    static void multiply(
+        long double*       c,
+        const long double* a,
+        const long double* b,
+        std::size_t        rows,
+        std::size_t        inner,
+        std::size_t        columns);
+};
+
+#endif // MAT_KERNELS_HPP_INCLUDED
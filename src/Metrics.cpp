@@ -0,0 +1,308 @@
+#include <cstdio>
+#include <fstream>
+#include "Metrics.hpp"
+
+// Name of the keyword counted at index i.
+static const char* keywordName(std::size_t i)
+{
+    return Token::getKeywordName(static_cast<Token::Value>(Token::TYPE_KEYWORD + 1 + i));
+}
+
+
+static const char* const LATENCY_NAMES[Metrics::TOTAL_LATENCIES] =
+{
+    "input",
+    "process",
+    "channel"
+};
+
+Metrics::Metrics() : m_isStopping(false)
+{
+    for (std::size_t i = 0; i < TOTAL_KEYWORDS; i++)
+        m_statements[i].store(0);
+
+    m_assignments.store(0);
+    m_evaluations.store(0);
+    m_jumps.store(0);
+    m_maxCallDepth.store(0);
+    m_inputBytes.store(0);
+    m_outputBytes.store(0);
+    m_realVariables.store(0);
+    m_integerVariables.store(0);
+    m_stringVariables.store(0);
+    m_arrays.store(0);
+    m_stringBytes.store(0);
+
+    for (std::size_t i = 0; i < TOTAL_LATENCIES; i++)
+    {
+        for (std::size_t j = 0; j < TOTAL_BUCKETS; j++)
+            m_latencies[i].buckets[j].store(0);
+
+        m_latencies[i].count.store(0);
+        m_latencies[i].sum.store(0);
+    }
+}
+
+
+Metrics::~Metrics()
+{
+    stopDump();
+}
+
+
+void Metrics::setVariables(
+    std::size_t reals,
+    std::size_t integers,
+    std::size_t strings,
+    std::size_t arrays,
+    std::size_t stringBytes)
+{
+    m_realVariables.store(reals, std::memory_order_relaxed);
+    m_integerVariables.store(integers, std::memory_order_relaxed);
+    m_stringVariables.store(strings, std::memory_order_relaxed);
+    m_arrays.store(arrays, std::memory_order_relaxed);
+    m_stringBytes.store(stringBytes, std::memory_order_relaxed);
+}
+
+
+void Metrics::recordLatency(Latency latency, std::uint64_t nanoseconds)
+{
+    std::uint64_t microseconds = nanoseconds / 1000;
+    std::size_t bucket = 0;
+
+    while ((0 != microseconds) && (bucket < TOTAL_BUCKETS - 1))
+        microseconds >>= 1, bucket++;
+
+    Buckets& buckets = m_latencies[latency];
+
+    add(buckets.buckets[bucket], 1);
+    add(buckets.count, 1);
+    add(buckets.sum, nanoseconds);
+}
+
+
+Metrics::Snapshot Metrics::getSnapshot() const
+{
+    Snapshot snapshot;
+
+    for (std::size_t i = 0; i < TOTAL_KEYWORDS; i++)
+        snapshot.statements[i] = m_statements[i].load(std::memory_order_relaxed);
+
+    snapshot.assignments = m_assignments.load(std::memory_order_relaxed);
+    snapshot.evaluations = m_evaluations.load(std::memory_order_relaxed);
+    snapshot.jumps = m_jumps.load(std::memory_order_relaxed);
+    snapshot.maxCallDepth = m_maxCallDepth.load(std::memory_order_relaxed);
+    snapshot.inputBytes = m_inputBytes.load(std::memory_order_relaxed);
+    snapshot.outputBytes = m_outputBytes.load(std::memory_order_relaxed);
+    snapshot.realVariables = m_realVariables.load(std::memory_order_relaxed);
+    snapshot.integerVariables = m_integerVariables.load(std::memory_order_relaxed);
+    snapshot.stringVariables = m_stringVariables.load(std::memory_order_relaxed);
+    snapshot.arrays = m_arrays.load(std::memory_order_relaxed);
+    snapshot.stringBytes = m_stringBytes.load(std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < TOTAL_LATENCIES; i++)
+    {
+        for (std::size_t j = 0; j < TOTAL_BUCKETS; j++)
+        {
+            snapshot.latencies[i].buckets[j] =
+                m_latencies[i].buckets[j].load(std::memory_order_relaxed);
+        }
+
+        snapshot.latencies[i].count = m_latencies[i].count.load(std::memory_order_relaxed);
+        snapshot.latencies[i].sum = m_latencies[i].sum.load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+
+void Metrics::writeJson(const Snapshot& snapshot, std::ostream& out)
+{
+    out << "{\n  \"statements\": {";
+
+    for (std::size_t i = 0; i < TOTAL_KEYWORDS; i++)
+    {
+        out << (0 == i ? "" : ", ") << '"' << keywordName(i) << "\": "
+            << snapshot.statements[i];
+    }
+
+    out << "},\n"
+        << "  \"assignments\": " << snapshot.assignments << ",\n"
+        << "  \"evaluations\": " << snapshot.evaluations << ",\n"
+        << "  \"jumps\": " << snapshot.jumps << ",\n"
+        << "  \"max_gosub_depth\": " << snapshot.maxCallDepth << ",\n"
+        << "  \"input_bytes\": " << snapshot.inputBytes << ",\n"
+        << "  \"output_bytes\": " << snapshot.outputBytes << ",\n"
+        << "  \"variables\": {\"real\": " << snapshot.realVariables
+        << ", \"integer\": " << snapshot.integerVariables
+        << ", \"string\": " << snapshot.stringVariables << "},\n"
+        << "  \"arrays\": " << snapshot.arrays << ",\n"
+        << "  \"string_bytes\": " << snapshot.stringBytes << ",\n"
+        << "  \"latencies\": {";
+
+    for (std::size_t i = 0; i < TOTAL_LATENCIES; i++)
+    {
+        const Histogram& histogram = snapshot.latencies[i];
+
+        out << (0 == i ? "\n" : ",\n") << "    \"" << LATENCY_NAMES[i]
+            << "\": {\"count\": " << histogram.count
+            << ", \"sum_ns\": " << histogram.sum << ", \"buckets_us\": [";
+
+        for (std::size_t j = 0; j < TOTAL_BUCKETS; j++)
+            out << (0 == j ? "" : ", ") << histogram.buckets[j];
+
+        out << "]}";
+    }
+
+    out << "\n  }\n}\n";
+}
+
+
+void Metrics::writePrometheus(const Snapshot& snapshot, std::ostream& out)
+{
+    out << "# HELP citbasic_statements_total Statements run, by keyword.\n"
+        << "# TYPE citbasic_statements_total counter\n";
+
+    for (std::size_t i = 0; i < TOTAL_KEYWORDS; i++)
+    {
+        out << "citbasic_statements_total{keyword=\"" << keywordName(i) << "\"} "
+            << snapshot.statements[i] << '\n';
+    }
+
+    struct Metric
+    {
+        const char*   name;
+        const char*   type;
+        const char*   help;
+        std::uint64_t value;
+    };
+
+    const Metric metrics[] =
+    {
+        { "citbasic_assignments_total", "counter", "Assignments run.", snapshot.assignments },
+        { "citbasic_evaluations_total", "counter", "Expressions evaluated.", snapshot.evaluations },
+        { "citbasic_jumps_total", "counter", "GOTO, GOSUB and RETURN taken.", snapshot.jumps },
+        { "citbasic_gosub_depth_max", "gauge", "Deepest GOSUB nesting.", snapshot.maxCallDepth },
+        { "citbasic_input_bytes_total", "counter", "Bytes read by INPUT.", snapshot.inputBytes },
+        { "citbasic_output_bytes_total", "counter", "Bytes printed.", snapshot.outputBytes },
+        { "citbasic_arrays", "gauge", "Arrays dimensioned.", snapshot.arrays },
+        { "citbasic_string_bytes", "gauge", "Bytes held by string values.", snapshot.stringBytes }
+    };
+
+    for (std::size_t i = 0; i < sizeof(metrics) / sizeof(metrics[0]); i++)
+    {
+        out << "# HELP " << metrics[i].name << ' ' << metrics[i].help << '\n'
+            << "# TYPE " << metrics[i].name << ' ' << metrics[i].type << '\n'
+            << metrics[i].name << ' ' << metrics[i].value << '\n';
+    }
+
+    out << "# HELP citbasic_variables Variables, by type.\n"
+        << "# TYPE citbasic_variables gauge\n"
+        << "citbasic_variables{type=\"real\"} " << snapshot.realVariables << '\n'
+        << "citbasic_variables{type=\"integer\"} " << snapshot.integerVariables << '\n'
+        << "citbasic_variables{type=\"string\"} " << snapshot.stringVariables << '\n';
+
+    out << "# HELP citbasic_latency_seconds Time spent waiting, by kind.\n"
+        << "# TYPE citbasic_latency_seconds histogram\n";
+
+    for (std::size_t i = 0; i < TOTAL_LATENCIES; i++)
+    {
+        const Histogram& histogram = snapshot.latencies[i];
+        std::uint64_t total = 0;
+
+        for (std::size_t j = 0; j < TOTAL_BUCKETS; j++)
+        {
+            total += histogram.buckets[j];
+
+            out << "citbasic_latency_seconds_bucket{kind=\"" << LATENCY_NAMES[i]
+                << "\",le=\"";
+
+            if (TOTAL_BUCKETS - 1 == j)
+                out << "+Inf";
+            else
+                out << static_cast<double>(std::uint64_t(1) << j) * 1e-6;
+
+            out << "\"} " << total << '\n';
+        }
+
+        out << "citbasic_latency_seconds_sum{kind=\"" << LATENCY_NAMES[i] << "\"} "
+            << static_cast<double>(histogram.sum) * 1e-9 << '\n'
+            << "citbasic_latency_seconds_count{kind=\"" << LATENCY_NAMES[i] << "\"} "
+            << histogram.count << '\n';
+    }
+}
+
+
+bool Metrics::dump(const std::string& fileName) const
+{
+    Snapshot snapshot = getSnapshot();
+    std::string temporary(fileName + ".tmp");
+
+    {
+        std::ofstream file(temporary.c_str(), std::ios::out | std::ios::trunc);
+
+        bool isJson = (fileName.size() >= 5) &&
+            (0 == fileName.compare(fileName.size() - 5, 5, ".json"));
+
+        if (isJson)
+            writeJson(snapshot, file);
+        else
+            writePrometheus(snapshot, file);
+
+        file.close();
+
+        if (file.fail())
+        {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(fileName.c_str());
+#endif
+
+    return 0 == std::rename(temporary.c_str(), fileName.c_str());
+}
+
+
+void Metrics::startDump(const std::string& fileName, double intervalSeconds)
+{
+    static const double MIN_INTERVAL = 0.01;
+
+    stopDump();
+
+    // Written so that NaN is caught too.
+    if (!(intervalSeconds >= MIN_INTERVAL))
+        intervalSeconds = MIN_INTERVAL;
+
+    m_dumpFileName = fileName;
+    m_isStopping = false;
+
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(intervalSeconds));
+
+    m_dumper = std::thread([this, interval]()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (!m_stop.wait_for(lock, interval, [this]() { return m_isStopping; }))
+            dump(m_dumpFileName);
+    });
+}
+
+
+void Metrics::stopDump()
+{
+    if (!m_dumper.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        m_stop.notify_all();
+    }
+
+    m_dumper.join();
+    dump(m_dumpFileName);
+}
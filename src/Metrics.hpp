@@ -0,0 +1,162 @@
+#ifndef METRICS_HPP_INCLUDED
+#define METRICS_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include "Token.hpp"
+
+// Counters, gauges and latency histograms of the runs of an execution, to
+// see what an interpreter is doing in production. The execution updates
+// them on its own thread with relaxed loads and stores, which cost what
+// plain increments do, and any thread may take a snapshot meanwhile. Only
+// one execution at a time may count into a registry; runs add up.
+class Metrics
+{
+public:
+
+    static const std::size_t TOTAL_KEYWORDS = Token::KEYWORD_TO - Token::TYPE_KEYWORD;
+
+    // Bucket i counts latencies under 2^i microseconds; the last one
+    // counts the rest.
+    static const std::size_t TOTAL_BUCKETS = 24;
+
+    enum Latency
+    {
+        LATENCY_INPUT,    // INPUT statements reading a stream
+        LATENCY_PROCESS,  // SHELL, EXEC, WAIT and their $ forms
+        LATENCY_CHANNEL,  // SEND and RECEIVE outside the scheduler
+        TOTAL_LATENCIES
+    };
+
+    struct Histogram
+    {
+        std::uint64_t buckets[TOTAL_BUCKETS];
+        std::uint64_t count;
+        std::uint64_t sum;  // nanoseconds
+    };
+
+    struct Snapshot
+    {
+        std::uint64_t statements[TOTAL_KEYWORDS];  // by keyword
+        std::uint64_t assignments;
+        std::uint64_t evaluations;                  // expressions evaluated
+        std::uint64_t jumps;                        // GOTO, GOSUB, RETURN
+        std::uint64_t maxCallDepth;
+        std::uint64_t inputBytes;
+        std::uint64_t outputBytes;                  // PRINT and INPUT prompts
+
+        // As of the last check of the limits, or the end of the run.
+        std::uint64_t realVariables;
+        std::uint64_t integerVariables;
+        std::uint64_t stringVariables;
+        std::uint64_t arrays;
+        std::uint64_t stringBytes;
+
+        Histogram latencies[TOTAL_LATENCIES];
+    };
+
+    Metrics();
+
+    // Stops dumping first.
+    ~Metrics();
+
+    static std::uint64_t now()
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Called by the execution that counts.
+    void countStatement(Token::Value keyword)
+    {
+        add(m_statements[keyword - Token::TYPE_KEYWORD - 1], 1);
+    }
+
+    void countAssignment() { add(m_assignments, 1); }
+    void countEvaluation() { add(m_evaluations, 1); }
+    void countJump() { add(m_jumps, 1); }
+    void countInput(std::size_t bytes) { add(m_inputBytes, bytes); }
+    void countOutput(std::size_t bytes) { add(m_outputBytes, bytes); }
+
+    void countCall(std::size_t depth)
+    {
+        if (depth > m_maxCallDepth.load(std::memory_order_relaxed))
+            m_maxCallDepth.store(depth, std::memory_order_relaxed);
+    }
+
+    void setVariables(
+        std::size_t reals,
+        std::size_t integers,
+        std::size_t strings,
+        std::size_t arrays,
+        std::size_t stringBytes);
+
+    void recordLatency(Latency latency, std::uint64_t nanoseconds);
+
+    Snapshot getSnapshot() const;
+
+    static void writeJson(const Snapshot& snapshot, std::ostream& out);
+    static void writePrometheus(const Snapshot& snapshot, std::ostream& out);
+
+    // Writes a snapshot to the file every interval from a thread of its
+    // own, and a last one on stopDump(); as JSON when the name ends in
+    // ".json", in the Prometheus text format otherwise. The file is
+    // replaced whole each time, so that readers never see half of one.
+    // Intervals shorter than 10 ms, zero and negative ones included, are
+    // taken as 10 ms.
+    void startDump(const std::string& fileName, double intervalSeconds);
+    void stopDump();
+
+    // Writes one snapshot as startDump() does.
+    bool dump(const std::string& fileName) const;
+
+private:
+
+    typedef std::atomic<std::uint64_t> Counter;
+
+    Metrics(const Metrics&);
+    Metrics& operator =(const Metrics&);
+
+    // Only the counting thread writes, so this need not be atomic.
+    static void add(Counter& counter, std::uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount,
+            std::memory_order_relaxed);
+    }
+
+    struct Buckets
+    {
+        Counter buckets[TOTAL_BUCKETS];
+        Counter count;
+        Counter sum;
+    };
+
+    Counter m_statements[TOTAL_KEYWORDS];
+    Counter m_assignments;
+    Counter m_evaluations;
+    Counter m_jumps;
+    Counter m_maxCallDepth;
+    Counter m_inputBytes;
+    Counter m_outputBytes;
+    Counter m_realVariables;
+    Counter m_integerVariables;
+    Counter m_stringVariables;
+    Counter m_arrays;
+    Counter m_stringBytes;
+    Buckets m_latencies[TOTAL_LATENCIES];
+
+    std::string             m_dumpFileName;
+    std::thread             m_dumper;
+    std::mutex              m_mutex;
+    std::condition_variable m_stop;
+    bool                    m_isStopping;
+};
+
+#endif // METRICS_HPP_INCLUDED
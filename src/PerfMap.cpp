@@ -0,0 +1,155 @@
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include "Program.hpp"
+#include "PerfMap.hpp"
+
+#if defined(__linux__) && defined(__x86_64__)
+#define PERF_MAP_SUPPORTED
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+PerfMap::PerfMap(const std::string& programName)
+    : m_programName(programName)
+    , m_code(nullptr)
+    , m_size(0)
+{
+}
+
+
+PerfMap::~PerfMap()
+{
+#ifdef PERF_MAP_SUPPORTED
+    // The map file stays; perf reads it after the process is gone.
+    if (nullptr != m_code)
+        ::munmap(m_code, m_size);
+#endif
+}
+
+
+bool PerfMap::isSupported()
+{
+#ifdef PERF_MAP_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+bool PerfMap::build(const Program& program, Entry target, std::ostream& err)
+{
+#ifdef PERF_MAP_SUPPORTED
+    if (nullptr != m_code)
+    {
+        ::munmap(m_code, m_size);
+        m_code = nullptr;
+    }
+
+    std::size_t totalLines = program.getTotalLines();
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+    m_size = ((totalLines * STUB_SIZE + page - 1) / page) * page;
+
+    if (0 == m_size)
+        m_size = page;
+
+    void* memory = ::mmap(
+        nullptr, m_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (MAP_FAILED == memory)
+    {
+        err << "Cannot allocate line stubs!\n";
+        return false;
+    }
+
+    m_code = static_cast<unsigned char*>(memory);
+
+    // push rbp; mov rbp, rsp; mov rax, target; call rax; pop rbp; ret.
+    // The frame keeps the stack aligned for the call and lets perf walk
+    // through the stub with frame pointers.
+    static const unsigned char stub[STUB_SIZE] =
+    {
+        0x55,
+        0x48, 0x89, 0xE5,
+        0x48, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0,
+        0xFF, 0xD0,
+        0x5D,
+        0xC3,
+        0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC,
+        0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC
+    };
+
+    for (std::size_t i = 0; i < m_size / STUB_SIZE; i++)
+    {
+        std::memcpy(m_code + i * STUB_SIZE, stub, STUB_SIZE);
+        std::memcpy(m_code + i * STUB_SIZE + 6, &target, sizeof(target));
+    }
+
+    if (0 != ::mprotect(m_code, m_size, PROT_READ | PROT_EXEC))
+    {
+        err << "Cannot make line stubs executable!\n";
+        ::munmap(m_code, m_size);
+        m_code = nullptr;
+        return false;
+    }
+
+    std::string fileName("/tmp/perf-");
+    fileName.append(std::to_string(::getpid())).append(".map");
+
+    std::ofstream map(fileName.c_str(), std::ios::out | std::ios::app);
+
+    if (!map.is_open())
+    {
+        err << "Cannot open \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    map << std::hex;
+
+    for (std::size_t i = 0; i < totalLines; i++)
+    {
+        map << reinterpret_cast<std::uintptr_t>(m_code + i * STUB_SIZE)
+            << ' ' << STUB_SIZE << ' '
+            << m_programName << ':' << std::dec
+            << program.getLineNumber(i) << std::hex;
+
+        // One line per symbol, so the source is flattened and cut short.
+        std::size_t written = 0;
+        bool blank = true;
+
+        for (const char* c = program.getSourceLine(i);
+             *c && (written < 60);
+             c++)
+        {
+            if (std::isspace(static_cast<unsigned char>(*c)))
+            {
+                blank = true;
+            }
+            else
+            {
+                if (blank)
+                    map << ' ';
+
+                map << *c;
+                blank = false;
+                written++;
+            }
+        }
+
+        map << '\n';
+    }
+
+    return true;
+#else
+    (void)program;
+    (void)target;
+
+    err << "Perf maps are only supported on x86-64 Linux!\n";
+    return false;
+#endif
+}
@@ -0,0 +1,51 @@
+#ifndef PERF_MAP_HPP_INCLUDED
+#define PERF_MAP_HPP_INCLUDED
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+class Program;
+
+// Makes native profilers see BASIC lines. Every line of the program gets
+// a tiny stub of machine code that sets up a frame and calls the
+// interpreter; the stubs are listed in /tmp/perf-<pid>.map, the file
+// Linux perf reads symbols of generated code from. Samples taken while a
+// line executes then have the stub of that line on their call chain, so
+// `perf report --children` attributes time to lines of the .bas file.
+//
+// Only x86-64 Linux is supported; elsewhere build() fails.
+class PerfMap
+{
+public:
+
+    typedef std::size_t (*Entry)(void* context, std::size_t line);
+
+    explicit PerfMap(const std::string& programName);
+    ~PerfMap();
+
+    static bool isSupported();
+
+    // Generates one stub per line of the loaded program, each calling
+    // the given function with its arguments unchanged, and writes the
+    // map file. Failures are reported to err.
+    bool build(const Program& program, Entry target, std::ostream& err);
+
+    Entry getEntry(std::size_t line) const
+    {
+        return reinterpret_cast<Entry>(m_code + line * STUB_SIZE);
+    }
+
+private:
+
+    PerfMap(const PerfMap&);
+    PerfMap& operator =(const PerfMap&);
+
+    static const std::size_t STUB_SIZE = 32;
+
+    std::string    m_programName;
+    unsigned char* m_code;
+    std::size_t    m_size;
+};
+
+#endif // PERF_MAP_HPP_INCLUDED
@@ -0,0 +1,232 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Process.hpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+Process::Process()
+    : m_status(-1)
+    , m_isRunning(false)
+#ifndef _WIN32
+    , m_pid(-1)
+    , m_pipe(-1)
+#endif
+{
+}
+
+
+Process::~Process()
+{
+    wait();
+}
+
+
+#ifdef _WIN32
+
+bool Process::start(const std::string& command, unsigned flags)
+{
+    wait();
+
+    m_output.clear();
+
+    if (0 == (flags & FLAG_CAPTURE))
+    {
+        m_status = std::system(command.c_str());
+        return true;
+    }
+
+    FILE* pipe = ::popen(command.c_str(), "rb");
+
+    if (nullptr == pipe)
+    {
+        m_status = -1;
+        return false;
+    }
+
+    char buffer[4096];
+    std::size_t size;
+
+    while (0 != (size = std::fread(buffer, 1, sizeof(buffer), pipe)))
+        m_output.append(buffer, size);
+
+    m_status = ::pclose(pipe);
+    return true;
+}
+
+
+int Process::wait()
+{
+    return m_status;
+}
+
+#else
+
+// Splits a command line into words for running without the shell.
+static std::vector<std::string> split(const std::string& command)
+{
+    std::vector<std::string> words;
+    std::string word;
+    bool isWord = false;
+    bool isQuoted = false;
+
+    for (std::size_t i = 0; i < command.size(); i++)
+    {
+        char c = command[i];
+
+        if ('"' == c)
+        {
+            isQuoted = !isQuoted;
+            isWord = true;
+        }
+        else if (!isQuoted && ((' ' == c) || ('\t' == c)))
+        {
+            if (isWord)
+                words.push_back(word), word.clear(), isWord = false;
+        }
+        else
+        {
+            word += c;
+            isWord = true;
+        }
+    }
+
+    if (isWord)
+        words.push_back(word);
+
+    return words;
+}
+
+
+bool Process::start(const std::string& command, unsigned flags)
+{
+    wait();
+
+    m_output.clear();
+    m_status = -1;
+
+    std::vector<std::string> words;
+
+    if (0 != (flags & FLAG_SHELL))
+    {
+        words.push_back("sh");
+        words.push_back("-c");
+        words.push_back(command);
+    }
+    else
+    {
+        words = split(command);
+    }
+
+    if (words.empty())
+        return false;
+
+    std::vector<char*> arguments;
+
+    for (std::size_t i = 0; i < words.size(); i++)
+        arguments.push_back(&words[i][0]);
+
+    arguments.push_back(nullptr);
+
+    // Both ends are closed on exec so that children spawned meanwhile by
+    // other threads do not keep the pipe open; dup2 clears the flag on the
+    // child's standard output.
+    int fds[2] = { -1, -1 };
+
+    posix_spawn_file_actions_t actions;
+    ::posix_spawn_file_actions_init(&actions);
+
+    if (0 != (flags & FLAG_CAPTURE))
+    {
+#ifdef __linux__
+        if (0 != ::pipe2(fds, O_CLOEXEC))
+#else
+        if ((0 != ::pipe(fds)) ||
+            (-1 == ::fcntl(fds[0], F_SETFD, FD_CLOEXEC)) ||
+            (-1 == ::fcntl(fds[1], F_SETFD, FD_CLOEXEC)))
+#endif
+        {
+            ::posix_spawn_file_actions_destroy(&actions);
+            return false;
+        }
+
+        ::posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    }
+
+    pid_t pid;
+
+    int result = (0 != (flags & FLAG_SHELL))
+        ? ::posix_spawn(&pid, "/bin/sh", &actions, nullptr, &arguments[0], environ)
+        : ::posix_spawnp(&pid, arguments[0], &actions, nullptr, &arguments[0], environ);
+
+    ::posix_spawn_file_actions_destroy(&actions);
+
+    if (-1 != fds[1])
+        ::close(fds[1]);
+
+    if (0 != result)
+    {
+        if (-1 != fds[0])
+            ::close(fds[0]);
+
+        return false;
+    }
+
+    m_pid = static_cast<int>(pid);
+    m_pipe = fds[0];
+    m_isRunning = true;
+    return true;
+}
+
+
+int Process::wait()
+{
+    if (!m_isRunning)
+        return m_status;
+
+    if (-1 != m_pipe)
+    {
+        char buffer[4096];
+
+        while (true)
+        {
+            ssize_t size = ::read(m_pipe, buffer, sizeof(buffer));
+
+            if (0 < size)
+                m_output.append(buffer, static_cast<std::size_t>(size));
+            else if ((0 == size) || (EINTR != errno))
+                break;
+        }
+
+        ::close(m_pipe);
+        m_pipe = -1;
+    }
+
+    int status;
+
+    while (-1 == ::waitpid(static_cast<pid_t>(m_pid), &status, 0))
+    {
+        if (EINTR != errno)
+        {
+            status = -1;
+            break;
+        }
+    }
+
+    m_status = status;
+    m_isRunning = false;
+    return m_status;
+}
+
+#endif
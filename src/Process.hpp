@@ -0,0 +1,52 @@
+#ifndef PROCESS_HPP_INCLUDED
+#define PROCESS_HPP_INCLUDED
+
+#include <string>
+
+// A child process started with posix_spawn, either through /bin/sh or
+// directly, in which case the command is split into words at blanks and
+// double quotes group words. Its standard output can be captured.
+//
+// On Windows commands always go through the command interpreter and run
+// to completion in start().
+class Process
+{
+public:
+
+    enum Flags
+    {
+        FLAG_SHELL   = 1,
+        FLAG_CAPTURE = 2
+    };
+
+    Process();
+
+    // Waits for a child that is still running.
+    ~Process();
+
+    // False when the child could not be started; wait() then returns -1.
+    bool start(const std::string& command, unsigned flags);
+
+    // Waits for the child to exit, reading its output first when it is
+    // captured, and returns its status as std::system() would. Later calls
+    // return the same status.
+    int wait();
+
+    const std::string& getOutput() const { return m_output; }
+
+private:
+
+    Process(const Process&);
+    Process& operator =(const Process&);
+
+    std::string m_output;
+    int         m_status;
+    bool        m_isRunning;
+
+#ifndef _WIN32
+    int m_pid;
+    int m_pipe;
+#endif
+};
+
+#endif // PROCESS_HPP_INCLUDED
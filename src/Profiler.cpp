@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <iomanip>
+#include "Program.hpp"
+#include "Profiler.hpp"
+
+void Profiler::reset(std::size_t totalLines)
+{
+    Line empty = { 0, 0, 0 };
+
+    m_lines.assign(totalLines, empty);
+    m_calls.clear();
+    m_jumps.clear();
+}
+
+
+void Profiler::finish(std::uint64_t stop)
+{
+    while (!m_calls.empty())
+    {
+        m_lines[m_calls.back().line].inclusive += stop - m_calls.back().start;
+        m_calls.pop_back();
+    }
+}
+
+
+std::uint64_t Profiler::getTotalExecuted() const
+{
+    std::uint64_t total = 0;
+
+    for (std::size_t i = 0; i < m_lines.size(); i++)
+        total += m_lines[i].count;
+
+    return total;
+}
+
+
+void Profiler::report(
+    std::ostream&      stream,
+    const Program& program) const
+{
+    std::vector<std::size_t> lines;
+    std::uint64_t total = 0;
+    std::uint64_t statements = 0;
+
+    for (std::size_t i = 0; i < m_lines.size(); i++)
+    {
+        if (0 != m_lines[i].count)
+        {
+            lines.push_back(i);
+            total += m_lines[i].exclusive;
+            statements += m_lines[i].count;
+        }
+    }
+
+    std::stable_sort(lines.begin(), lines.end(),
+        [this](std::size_t a, std::size_t b) -> bool
+        {
+            return m_lines[a].exclusive > m_lines[b].exclusive;
+        });
+
+    stream << "Profile: " << statements << " lines executed, "
+           << total << " " << unit() << "\n\n";
+
+    stream << std::setw(6)  << "Line"      << " "
+           << std::setw(12) << "Count"     << " "
+           << std::setw(16) << "Exclusive" << " "
+           << std::setw(6)  << "%"         << " "
+           << std::setw(16) << "Inclusive" << "  Source\n";
+
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        const Line& entry = m_lines[lines[i]];
+
+        stream << std::setw(6)  << program.getLineNumber(lines[i]) << " "
+               << std::setw(12) << entry.count << " "
+               << std::setw(16) << entry.exclusive << " "
+               << std::setw(6)  << std::fixed << std::setprecision(2)
+               << (0 == total ? 0.0 : 100.0 * entry.exclusive / total) << " "
+               << std::setw(16) << entry.inclusive << "  "
+               << program.getSourceLine(lines[i]) << "\n";
+    }
+
+    std::vector<std::pair<std::uint64_t, std::uint64_t> > jumps(
+        m_jumps.begin(), m_jumps.end());
+
+    // Most taken first; ties in source order so that reports diff well.
+    std::sort(jumps.begin(), jumps.end(),
+        [](const std::pair<std::uint64_t, std::uint64_t>& a,
+           const std::pair<std::uint64_t, std::uint64_t>& b) -> bool
+        {
+            return (a.second != b.second) ? a.second > b.second
+                                          : a.first < b.first;
+        });
+
+    stream << "\n" << std::setw(6) << "From" << " "
+           << std::setw(6) << "To" << " "
+           << std::setw(12) << "Taken" << "  Source\n";
+
+    for (std::size_t i = 0; i < jumps.size(); i++)
+    {
+        std::size_t from = static_cast<std::size_t>(jumps[i].first >> 32);
+        std::size_t to = static_cast<std::size_t>(jumps[i].first & 0xFFFFFFFF);
+
+        stream << std::setw(6)  << program.getLineNumber(from) << " "
+               << std::setw(6)  << program.getLineNumber(to) << " "
+               << std::setw(12) << jumps[i].second << "  "
+               << program.getSourceLine(from) << "\n";
+    }
+}
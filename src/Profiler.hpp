@@ -0,0 +1,120 @@
+#ifndef PROFILER_HPP_INCLUDED
+#define PROFILER_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+class Program;
+
+// Per-line execution profile: how often each line ran, the time spent in
+// the line itself (exclusive) and including the subroutines it called via
+// GOSUB (inclusive), and how often every non-sequential transfer of
+// control was taken.
+class Profiler
+{
+public:
+
+    // Cheap timestamp; the time stamp counter where there is one.
+    static std::uint64_t now()
+    {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static const char* unit()
+    {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return "cycles";
+#else
+        return "ns";
+#endif
+    }
+
+    void reset(std::size_t totalLines);
+
+    // Accounts one executed line. Call stack depths before and after the
+    // line tell GOSUB and RETURN apart from other statements.
+    void record(
+        std::size_t   line,
+        std::size_t   next,
+        std::uint64_t start,
+        std::uint64_t stop,
+        std::size_t   depthBefore,
+        std::size_t   depthAfter)
+    {
+        Line& entry = m_lines[line];
+        const std::uint64_t elapsed = stop - start;
+
+        entry.count++;
+        entry.exclusive += elapsed;
+
+        if (depthAfter > depthBefore)
+        {
+            Call call;
+            call.line  = line;
+            call.start = start;
+            m_calls.push_back(call);
+        }
+        else
+        {
+            entry.inclusive += elapsed;
+
+            if ((depthAfter < depthBefore) && !m_calls.empty())
+            {
+                m_lines[m_calls.back().line].inclusive +=
+                    stop - m_calls.back().start;
+                m_calls.pop_back();
+            }
+        }
+
+        if ((line + 1 != next) && (next < m_lines.size()))
+            m_jumps[(static_cast<std::uint64_t>(line) << 32) | next]++;
+    }
+
+    // Closes subroutine calls the program never returned from.
+    void finish(std::uint64_t stop);
+
+    void report(std::ostream& stream, const Program& program) const;
+
+    // Lines executed since the last reset.
+    std::uint64_t getTotalExecuted() const;
+
+private:
+
+    struct Line
+    {
+        std::uint64_t count;
+        std::uint64_t exclusive;
+        std::uint64_t inclusive;
+    };
+
+    struct Call
+    {
+        std::size_t   line;
+        std::uint64_t start;
+    };
+
+    std::vector<Line> m_lines;
+    std::vector<Call> m_calls;
+
+    // (from << 32 | to) -> times taken
+    std::unordered_map<std::uint64_t, std::uint64_t> m_jumps;
+};
+
+#endif // PROFILER_HPP_INCLUDED
@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include "Program.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4996)
+#endif
+
+void Program::read(
+    std::istream&             file,
+    std::vector<std::string>& lines,
+    std::vector<std::size_t>& lineNumbers)
+{
+    std::string buffer;
+    std::size_t physical = 0;
+
+    while (!file.eof())
+    { 
+        buffer.clear();
+
+        std::size_t first = physical + 1;
+
+        while (true)
+        {
+            std::string line;
+            std::getline(file, line);
+            physical++;
+
+            while (!line.empty() && !std::isgraph(line[line.size() - 1]))
+                line.resize(line.size() - 1);
+
+            if (line.empty())
+                break;
+
+            if ('&' == line[line.size() - 1])
+            {
+                line.resize(line.size() - 1);
+                buffer.append(line);
+                buffer += ' ';
+            }
+            else
+            {
+                buffer.append(line);
+                break;
+            }
+        }
+
+        if (!buffer.empty())
+        {
+            lines.push_back(buffer);
+            lineNumbers.push_back(first);
+        }
+    }
+}
+
+
+bool Program::tokenize(std::size_t line, std::ostream& err)
+{
+    Token token;
+
+    const char* end = m_source[line].get() + std::strlen(m_source[line].get());
+    const char* current = token.parse(m_source[line].get(), end);
+
+    bool expectColon = false;
+
+    if (Token::LITERAL_INTEGER == token.getValue())
+    {
+        if (!registerLabel(token, line, err))
+            return false;
+
+        current = token.parse(current, end);
+    }
+    else if (Token::IDENTIFIER_LABEL == token.getValue())
+    {
+        expectColon = true;
+    }
+
+    VectorOfTokens& tokens = m_tokens[line];
+
+    while ((Token::HAPPY_END   != token.getType()) &&
+           (Token::KEYWORD_REM != token.getValue()))
+    {
+        if (Token::TYPE_IDENTIFIER == token.getType())
+            token.setSlot(registerName(token.getIdentifier()));
+
+        tokens.push_back(token);
+        current = token.parse(current, end);
+
+        if (expectColon &&
+            (Token::PUNCTUATION_MARK_COLON == token.getValue()))
+        {
+            if (!registerLabel(tokens.back(), line, err))
+                return false;
+
+            tokens.pop_back();
+            current = token.parse(current, end);
+            expectColon = false;
+        }
+    }
+
+    return true;
+}
+
+
+static Program::SourceLine copyLine(const std::string& text)
+{
+    Program::SourceLine result(new char[text.size() + 1]);
+    std::strcpy(result.get(), text.c_str());
+    return result;
+}
+
+
+bool Program::load(std::istream& file, std::ostream& err)
+{
+    m_source.clear();
+    m_tokens.clear();
+    m_lineNumbers.clear();
+    m_labels.clear();
+    m_slots.clear();
+    m_names.clear();
+    m_retired.clear();
+
+    std::vector<std::string> lines;
+    read(file, lines, m_lineNumbers);
+
+    m_tokens.resize(lines.size());
+
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        m_source.push_back(copyLine(lines[i]));
+
+        if (!tokenize(i, err))
+            return false;
+    }
+
+    updateHash();
+    return true;
+}
+
+
+void Program::updateHash()
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for (std::size_t i = 0; i < m_source.size(); i++)
+    {
+        for (const char* c = m_source[i].get(); ; c++)
+        {
+            // Lines end with a line feed, which no line contains.
+            hash ^= static_cast<unsigned char>(('\0' != *c) ? *c : '\n');
+            hash *= 1099511628211ULL;
+
+            if ('\0' == *c)
+                break;
+        }
+    }
+
+    m_hash = hash;
+}
+
+
+// Beyond this many inserted and removed lines, the lines between the
+// first and the last change are all taken as changed.
+static const std::size_t MAX_EDITS = 1024;
+
+// Finds the longest run of lines common to a[begin, end) and b[begin,
+// end) in order, with Myers' algorithm, and records in kept the index in
+// b of every line of a in it.
+template <typename Equal>
+static bool match(
+    std::size_t               aBegin,
+    std::size_t               aEnd,
+    std::size_t               bBegin,
+    std::size_t               bEnd,
+    Equal                     equal,
+    std::vector<std::size_t>& kept)
+{
+    typedef std::ptrdiff_t Index;
+
+    const Index n = static_cast<Index>(aEnd - aBegin);
+    const Index m = static_cast<Index>(bEnd - bBegin);
+    const Index limit = std::min<Index>(n + m, MAX_EDITS);
+
+    // v[k + offset] is the furthest x reached on diagonal k = x - y; the
+    // trace keeps the part of v that each round started from.
+    const Index offset = limit + 1;
+    std::vector<Index> v(2 * limit + 3, 0);
+    std::vector<std::vector<Index>> trace;
+
+    Index d;
+    bool isFound = false;
+
+    for (d = 0; (d <= limit) && !isFound; d++)
+    {
+        trace.push_back(std::vector<Index>(
+            v.begin() + (offset - d - 1), v.begin() + (offset + d + 2)));
+
+        for (Index k = -d; k <= d; k += 2)
+        {
+            Index x = ((k == -d) || ((k != d) && (v[offset + k - 1] < v[offset + k + 1])))
+                ? v[offset + k + 1]
+                : v[offset + k - 1] + 1;
+            Index y = x - k;
+
+            while ((x < n) && (y < m) && equal(aBegin + x, bBegin + y))
+                x++, y++;
+
+            v[offset + k] = x;
+
+            if ((x >= n) && (y >= m))
+            {
+                isFound = true;
+                break;
+            }
+        }
+    }
+
+    if (!isFound)
+        return false;
+
+    Index x = n;
+    Index y = m;
+
+    while (0 != d--)
+    {
+        const std::vector<Index>& round = trace[d];
+
+        Index k = x - y;
+        Index previousK =
+            ((k == -d) || ((k != d) && (round[k - 1 + d + 1] < round[k + 1 + d + 1])))
+            ? k + 1
+            : k - 1;
+        Index previousX = round[previousK + d + 1];
+        Index previousY = previousX - previousK;
+
+        while ((x > previousX) && (y > previousY))
+        {
+            x--, y--;
+            kept[aBegin + x] = bBegin + y;
+        }
+
+        x = previousX;
+        y = previousY;
+    }
+
+    return true;
+}
+
+
+bool Program::reload(std::istream& file, LineMap& lineMap, std::ostream& err)
+{
+    std::vector<std::string> lines;
+    std::vector<std::size_t> lineNumbers;
+    read(file, lines, lineNumbers);
+
+    const std::size_t oldSize = m_source.size();
+    const std::size_t newSize = lines.size();
+
+    auto equal = [&](std::size_t a, std::size_t b) -> bool
+    {
+        return lines[b] == m_source[a].get();
+    };
+
+    // Edits are usually few and close together, so the common head and
+    // tail are matched first.
+    std::vector<std::size_t> kept(oldSize, SIZE_MAX);
+    std::size_t head = 0;
+    std::size_t tail = 0;
+
+    while ((head < oldSize) && (head < newSize) && equal(head, head))
+        kept[head] = head, head++;
+
+    while ((tail < oldSize - head) && (tail < newSize - head) &&
+        equal(oldSize - 1 - tail, newSize - 1 - tail))
+    {
+        kept[oldSize - 1 - tail] = newSize - 1 - tail;
+        tail++;
+    }
+
+    if (!match(head, oldSize - tail, head, newSize - tail, equal, kept))
+        std::fill(kept.begin() + head, kept.end() - tail, SIZE_MAX);
+
+    // The new version is put together aside, so that a failure leaves
+    // this one as it was. Unchanged lines keep their tokens, which point
+    // into their text, and their labels.
+    Program next;
+    next.m_tokens.resize(newSize);
+    next.m_source.resize(newSize);
+    next.m_lineNumbers.swap(lineNumbers);
+    next.m_slots = m_slots;
+    next.m_names = m_names;
+
+    for (std::size_t i = 0; i < oldSize; i++)
+    {
+        if (SIZE_MAX != kept[i])
+            next.m_tokens[kept[i]] = m_tokens[i];
+    }
+
+    for (auto label = m_labels.begin(); label != m_labels.end(); ++label)
+    {
+        if (SIZE_MAX != kept[label->second])
+            next.m_labels[label->first] = kept[label->second];
+    }
+
+    std::vector<bool> isNew(newSize, true);
+
+    for (std::size_t i = 0; i < oldSize; i++)
+    {
+        if (SIZE_MAX != kept[i])
+            isNew[kept[i]] = false;
+    }
+
+    for (std::size_t i = 0; i < newSize; i++)
+    {
+        if (isNew[i])
+        {
+            next.m_source[i] = copyLine(lines[i]);
+
+            if (!next.tokenize(i, err))
+                return false;
+        }
+    }
+
+    lineMap.resize(oldSize);
+
+    std::size_t place = 0;
+
+    for (std::size_t i = 0; i < oldSize; i++)
+    {
+        if (SIZE_MAX != kept[i])
+        {
+            next.m_source[kept[i]] = std::move(m_source[i]);
+            place = kept[i] + 1;
+
+            lineMap[i].line = kept[i];
+            lineMap[i].isKept = true;
+        }
+        else
+        {
+            m_retired.push_back(std::move(m_source[i]));
+
+            lineMap[i].line = place;
+            lineMap[i].isKept = false;
+        }
+    }
+
+    m_tokens.swap(next.m_tokens);
+    m_source.swap(next.m_source);
+    m_lineNumbers.swap(next.m_lineNumbers);
+    m_labels.swap(next.m_labels);
+    m_slots.swap(next.m_slots);
+    m_names.swap(next.m_names);
+
+    updateHash();
+    return true;
+}
+
+
+std::size_t Program::findLabel(const std::string& key) const
+{
+    auto label = m_labels.find(key);
+    return (m_labels.end() == label) ? SIZE_MAX : label->second;
+}
+
+
+std::size_t Program::registerName(const std::string& name)
+{
+    auto slot = m_slots.find(name);
+
+    if (m_slots.end() != slot)
+        return slot->second;
+
+    m_slots[name] = m_names.size();
+    m_names.push_back(name);
+
+    return m_names.size() - 1;
+}
+
+
+bool Program::registerLabel(const Token& token, std::size_t line, std::ostream& err)
+{
+    assert(line < m_tokens.size());
+
+    std::stringstream key;
+
+    switch (token.getValue())
+    {
+    case Token::IDENTIFIER_LABEL:
+        key << token.getIdentifier();
+        break;
+
+    case Token::LITERAL_INTEGER:
+        key << token.getInteger();
+        break;
+
+    default:
+        err << "Internal error!\n";
+        return false;
+    }
+
+    std::pair<std::map<std::string, std::size_t>::iterator, bool> result =
+        m_labels.insert(std::pair<std::string, std::size_t>(
+            key.str(), line));
+
+    if (!result.second)
+    {
+        err << "Duplicate label \'" << key.str() << "\'!\n";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef PROGRAM_HPP_INCLUDED
+#define PROGRAM_HPP_INCLUDED
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Token.hpp"
+
+// A loaded program: the tokens of every logical line, its source text and
+// its labels. Only load() and reload() change it, so any number of
+// executions may share one program across threads as long as neither is
+// called. A program that is reloaded while it runs has a single owner,
+// which runs one execution of it and reloads it only between calls to
+// Execution::resume(); see Execution::relocate().
+class Program
+{
+public:
+
+    typedef std::vector<Token>      VectorOfTokens;
+    typedef std::unique_ptr<char[]> SourceLine;
+
+    // Where a line of the previous text went on reload(): its new index
+    // when it is unchanged, otherwise the index of the line that now
+    // stands in its place.
+    struct Relocation
+    {
+        std::size_t line;
+        bool        isKept;
+    };
+
+    typedef std::vector<Relocation> LineMap;
+
+    Program() : m_hash(0) {}
+
+    // Load errors are reported to err.
+    bool load(std::istream& file, std::ostream& err = std::cerr);
+
+    // Loads a new version of the text, tokenizing only the logical lines
+    // that differ from the current ones, and tells in lineMap where each
+    // current line went. Nothing changes when the new text fails to load.
+    // No execution may be running meanwhile; see Execution::relocate().
+    bool reload(std::istream& file, LineMap& lineMap, std::ostream& err = std::cerr);
+
+    // Frees the text of the lines that reload() replaced. String values of
+    // a run may refer to it until Execution::relocate() or start().
+    void releaseRetired() { m_retired.clear(); }
+
+    std::size_t getTotalLines() const { return m_tokens.size(); }
+
+    const std::vector<VectorOfTokens>& getTokens() const { return m_tokens; }
+
+    // Text of a logical line, continuation lines joined, and the number of
+    // the physical line it starts at.
+    const char* getSourceLine(std::size_t line) const { return m_source[line].get(); }
+    std::size_t getLineNumber(std::size_t line) const { return m_lineNumbers[line]; }
+
+    // FNV-1a hash of the text of all lines, which checkpoints are checked
+    // against.
+    std::uint64_t getHash() const { return m_hash; }
+
+    // Every identifier token carries the slot of its name, the identifier
+    // uppercased, so that executions can keep what they hold per name in
+    // vectors. reload() keeps the slots of the names already known.
+    std::size_t getTotalNames() const { return m_names.size(); }
+    const std::string& getName(std::size_t slot) const { return m_names[slot]; }
+
+    // Line a GOTO or GOSUB label refers to, or SIZE_MAX.
+    std::size_t findLabel(const std::string& key) const;
+
+private:
+
+    Program(const Program&);
+    Program& operator =(const Program&);
+
+    // Logical lines of the text, continuation lines joined, and the
+    // physical lines they start at.
+    static void read(
+        std::istream&             file,
+        std::vector<std::string>& lines,
+        std::vector<std::size_t>& lineNumbers);
+
+    // Tokenizes the text of the line and registers its labels.
+    bool tokenize(std::size_t line, std::ostream& err);
+
+    bool registerLabel(const Token& token, std::size_t line, std::ostream& err);
+
+    // Slot of the name, a new one if it is not known yet.
+    std::size_t registerName(const std::string& name);
+
+    void updateHash();
+
+    std::vector<VectorOfTokens> m_tokens;
+    std::vector<SourceLine>     m_source;
+    std::vector<std::size_t>    m_lineNumbers;
+
+    // Text of the lines that reload() replaced. String values of a run
+    // may still refer to their literals, so it is kept until load() or
+    // releaseRetired().
+    std::vector<SourceLine> m_retired;
+
+    std::map<std::string, std::size_t> m_labels;
+    std::map<std::string, std::size_t> m_slots;
+    std::vector<std::string>           m_names;
+    std::uint64_t                      m_hash;
+};
+
+#endif // PROGRAM_HPP_INCLUDED
@@ -0,0 +1,115 @@
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "ProgramCache.hpp"
+
+ProgramCache::ProgramCache(std::size_t capacity)
+    : m_capacity(capacity)
+    , m_totalHits(0)
+    , m_totalMisses(0)
+{
+    if (0 == m_capacity)
+        m_capacity = 1;
+}
+
+
+bool ProgramCache::getStamp(const std::string& fileName, Stamp& stamp)
+{
+#ifdef _WIN32
+    struct _stat64 status;
+
+    if (0 != ::_stat64(fileName.c_str(), &status))
+        return false;
+
+    stamp.modified = static_cast<std::int64_t>(status.st_mtime) * 1000000000;
+#else
+    struct stat status;
+
+    if (0 != ::stat(fileName.c_str(), &status))
+        return false;
+
+#ifdef __APPLE__
+    const timespec& modified = status.st_mtimespec;
+#else
+    const timespec& modified = status.st_mtim;
+#endif
+
+    stamp.modified =
+        static_cast<std::int64_t>(modified.tv_sec) * 1000000000 + modified.tv_nsec;
+#endif
+
+    stamp.size = static_cast<std::uint64_t>(status.st_size);
+    return true;
+}
+
+
+// The file is loaded without the lock held, so a slow load holds up no
+// other file. Two threads may then load the same file at once; the later
+// one simply replaces the earlier one's program.
+std::shared_ptr<const Program> ProgramCache::get(
+    const std::string& fileName,
+    std::ostream&      err)
+{
+    Stamp stamp;
+
+    if (!getStamp(fileName, stamp))
+    {
+        err << "Cannot open \"" << fileName << "\"!\n";
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto found = m_entries.find(fileName);
+
+        if ((m_entries.end() != found) && (found->second.stamp == stamp))
+        {
+            m_recent.splice(m_recent.begin(), m_recent, found->second.recent);
+            m_totalHits++;
+            return found->second.program;
+        }
+
+        m_totalMisses++;
+    }
+
+    std::ifstream file(fileName.c_str(), std::ios::in);
+
+    if (!file.is_open())
+    {
+        err << "Cannot open \"" << fileName << "\"!\n";
+        return nullptr;
+    }
+
+    std::shared_ptr<Program> program(new Program());
+
+    if (!program->load(file, err))
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Only programs that loaded are ever entered, so an entry without one
+    // has just been made.
+    Entry& entry = m_entries[fileName];
+
+    if (nullptr == entry.program)
+    {
+        m_recent.push_front(fileName);
+        entry.recent = m_recent.begin();
+    }
+    else
+    {
+        m_recent.splice(m_recent.begin(), m_recent, entry.recent);
+    }
+
+    entry.program = program;
+    entry.stamp = stamp;
+
+    while (m_entries.size() > m_capacity)
+    {
+        m_entries.erase(m_recent.back());
+        m_recent.pop_back();
+    }
+
+    return program;
+}
@@ -0,0 +1,71 @@
+#ifndef PROGRAM_CACHE_HPP_INCLUDED
+#define PROGRAM_CACHE_HPP_INCLUDED
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include "Program.hpp"
+
+// Loaded programs by file name, so a script that is run again and again
+// is read and tokenized once. A file is reloaded when its modification
+// time or size has changed; the least recently used programs are dropped
+// once there are more than the capacity. Safe to use from any thread, and
+// a program stays valid for as long as it is held, even after it has been
+// dropped.
+class ProgramCache
+{
+public:
+
+    static const std::size_t DEFAULT_CAPACITY = 64;
+
+    explicit ProgramCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+    // Null when the file cannot be opened or loaded; the errors go to err.
+    std::shared_ptr<const Program> get(const std::string& fileName, std::ostream& err);
+
+    std::uint64_t getTotalHits() const { return m_totalHits; }
+    std::uint64_t getTotalMisses() const { return m_totalMisses; }
+
+    // What tells one version of a file from the next.
+    struct Stamp
+    {
+        Stamp() : modified(0), size(0) {}
+
+        bool operator ==(const Stamp& other) const
+        {
+            return (modified == other.modified) && (size == other.size);
+        }
+
+        std::int64_t  modified;  // nanoseconds, where the system has them
+        std::uint64_t size;
+    };
+
+    // False when the file cannot be found.
+    static bool getStamp(const std::string& fileName, Stamp& stamp);
+
+private:
+
+    ProgramCache(const ProgramCache&);
+    ProgramCache& operator =(const ProgramCache&);
+
+    struct Entry
+    {
+        std::shared_ptr<const Program>   program;
+        Stamp                            stamp;
+        std::list<std::string>::iterator recent;
+    };
+
+    std::size_t m_capacity;
+
+    std::mutex                             m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::list<std::string>                 m_recent;  // most recent first
+    std::uint64_t                          m_totalHits;
+    std::uint64_t                          m_totalMisses;
+};
+
+#endif // PROGRAM_CACHE_HPP_INCLUDED
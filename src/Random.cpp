@@ -0,0 +1,87 @@
+#include "Random.hpp"
+
+void Random::seed(std::uint64_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        std::uint64_t z = (value += 0x9E3779B97F4A7C15);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        m_state[i] = z ^ (z >> 31);
+    }
+}
+
+
+// The jump polynomial of the generator's authors.
+void Random::jump()
+{
+    static const std::uint64_t JUMP[] =
+    {
+        0x180EC6D33CFD0ABA, 0xD5A61266F0C9392C, 0xA9582618E03FC9AA, 0x39ABDC4529B1661C
+    };
+
+    std::uint64_t state[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int bit = 0; bit < 64; bit++)
+        {
+            if (0 != (JUMP[i] & (std::uint64_t(1) << bit)))
+            {
+                for (int k = 0; k < 4; k++)
+                    state[k] ^= m_state[k];
+            }
+
+            (*this)();
+        }
+    }
+
+    for (int k = 0; k < 4; k++)
+        m_state[k] = state[k];
+}
+
+
+void Random::fill(long double* values, std::size_t count, long double scale)
+{
+    for (std::size_t i = 0; i < count; i++)
+        values[i] = real() * scale;
+}
+
+
+// The threshold of below() is worked out once for the whole array.
+void Random::fill(std::int64_t* values, std::size_t count, std::uint64_t bound)
+{
+    std::uint64_t threshold = (0 - bound) % bound;
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::uint64_t low;
+        std::uint64_t high = multiply((*this)(), bound, low);
+
+        while (low < threshold)
+            high = multiply((*this)(), bound, low);
+
+        values[i] = static_cast<std::int64_t>(high);
+    }
+}
+
+
+std::ostream& operator <<(std::ostream& stream, const Random& random)
+{
+    return stream << random.m_state[0] << ' ' << random.m_state[1] << ' '
+                  << random.m_state[2] << ' ' << random.m_state[3];
+}
+
+
+std::istream& operator >>(std::istream& stream, Random& random)
+{
+    std::uint64_t state[4];
+
+    if (stream >> state[0] >> state[1] >> state[2] >> state[3])
+    {
+        for (int k = 0; k < 4; k++)
+            random.m_state[k] = state[k];
+    }
+
+    return stream;
+}
@@ -0,0 +1,116 @@
+#ifndef RANDOM_HPP_INCLUDED
+#define RANDOM_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Generator behind RND: xoshiro256** (D. Blackman and S. Vigna), 256 bits
+// of state, a period of 2^256 - 1 and a handful of instructions a number.
+// A seed is spread over the state with SplitMix64, so that neighbouring
+// seeds start unrelated sequences. Every execution has its own.
+class Random
+{
+public:
+
+    Random() { seed(0); }
+
+    void seed(std::uint64_t value);
+
+    std::uint64_t operator ()()
+    {
+        std::uint64_t result = rotate(m_state[1] * 5, 7) * 9;
+        std::uint64_t t = m_state[1] << 17;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotate(m_state[3], 45);
+
+        return result;
+    }
+
+    // Uniform in [0, bound), bound not zero. The top half of a 128-bit
+    // product is unbiased once the few numbers whose low half falls under
+    // 2^64 mod bound are drawn again (D. Lemire), so the remainder is only
+    // computed when the low half is small enough to be one of them.
+    std::uint64_t below(std::uint64_t bound)
+    {
+        std::uint64_t low;
+        std::uint64_t high = multiply((*this)(), bound, low);
+
+        if (low < bound)
+        {
+            std::uint64_t threshold = (0 - bound) % bound;
+
+            while (low < threshold)
+                high = multiply((*this)(), bound, low);
+        }
+
+        return high;
+    }
+
+    // Uniform in [0, 1), from the top 53 bits.
+    double real()
+    {
+        return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Moves 2^128 numbers ahead. Generators seeded alike and then jumped
+    // 0, 1, 2... times give sequences that do not overlap for as long as
+    // anyone can run them.
+    void jump();
+
+    // Same as count calls of real() times scale, and of below(bound).
+    void fill(long double* values, std::size_t count, long double scale);
+    void fill(std::int64_t* values, std::size_t count, std::uint64_t bound);
+
+    // The state as four decimal numbers, for checkpoints.
+    friend std::ostream& operator <<(std::ostream& stream, const Random& random);
+    friend std::istream& operator >>(std::istream& stream, Random& random);
+
+private:
+
+    static std::uint64_t rotate(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Returns the high half of a * b.
+    static std::uint64_t multiply(std::uint64_t a, std::uint64_t b, std::uint64_t& low)
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        low = static_cast<std::uint64_t>(product);
+        return static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        std::uint64_t high;
+        low = _umul128(a, b, &high);
+        return high;
+#else
+        std::uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+        std::uint64_t bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+
+        std::uint64_t ll = aLow * bLow;
+        std::uint64_t lh = aLow * bHigh;
+        std::uint64_t hl = aHigh * bLow;
+        std::uint64_t hh = aHigh * bHigh;
+
+        std::uint64_t middle = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+
+        low = (middle << 32) | (ll & 0xFFFFFFFF);
+        return hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+    }
+
+    std::uint64_t m_state[4];
+};
+
+#endif // RANDOM_HPP_INCLUDED
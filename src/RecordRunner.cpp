@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include "Execution.hpp"
+#include "RecordRunner.hpp"
+
+RecordRunner::RecordRunner(const Program& program, unsigned totalThreads)
+    : m_program(program)
+    , m_totalThreads(totalThreads)
+    , m_isSeeded(false)
+    , m_seed(0)
+{
+    if (0 == m_totalThreads)
+        m_totalThreads = std::thread::hardware_concurrency();
+
+    if (0 == m_totalThreads)
+        m_totalThreads = 1;
+}
+
+
+std::size_t RecordRunner::run(
+    const char*   data,
+    std::size_t   size,
+    std::ostream& out,
+    std::ostream& err) const
+{
+    // Lets an Execution read a record in place.
+    class RecordBuffer : public std::streambuf
+    {
+    public:
+
+        RecordBuffer(const char* begin, const char* end)
+        {
+            char* b = const_cast<char*>(begin);
+            setg(b, b, b + (end - begin));
+        }
+    };
+
+    struct Record
+    {
+        const char* begin;
+        const char* end;
+    };
+
+    struct Chunk
+    {
+        std::string output;
+        std::string errors;
+        bool        isDone;
+    };
+
+    struct Queue
+    {
+        std::mutex              mutex;
+        std::deque<std::size_t> chunks;
+    };
+
+    std::vector<Record> records;
+
+    for (const char* begin = data; begin < data + size;)
+    {
+        const char* end = static_cast<const char*>(
+            std::memchr(begin, '\n', data + size - begin));
+
+        const char* next = (nullptr == end) ? data + size : end + 1;
+
+        if (nullptr == end)
+            end = data + size;
+
+        if ((end > begin) && ('\r' == end[-1]))
+            end--;
+
+        Record record = { begin, end };
+        records.push_back(record);
+
+        begin = next;
+    }
+
+    const std::size_t totalChunks =
+        (records.size() + RECORDS_PER_CHUNK - 1) / RECORDS_PER_CHUNK;
+
+    const std::size_t totalThreads =
+        std::max<std::size_t>(1, std::min<std::size_t>(m_totalThreads, totalChunks));
+
+    std::random_device device;
+    const std::uint64_t seed = m_isSeeded
+        ? m_seed
+        : ((static_cast<std::uint64_t>(device()) << 32) | device());
+
+    std::vector<Chunk> chunks(totalChunks);
+    std::unique_ptr<Queue[]> queues(new Queue[totalThreads]);
+
+    for (std::size_t i = 0; i < totalChunks; i++)
+    {
+        chunks[i].isDone = false;
+        queues[i * totalThreads / totalChunks].chunks.push_back(i);
+    }
+
+    std::mutex flushMutex;
+    std::size_t flushed = 0;
+    std::atomic<std::size_t> failed(0);
+
+    // Own chunks from the front, so that output can be flushed early;
+    // stolen ones from the back, as far from the owner as possible.
+    auto take = [&](std::size_t self, std::size_t& chunk) -> bool
+    {
+        for (std::size_t k = 0; k < totalThreads; k++)
+        {
+            Queue& queue = queues[(self + k) % totalThreads];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (!queue.chunks.empty())
+            {
+                if (0 == k)
+                {
+                    chunk = queue.chunks.front();
+                    queue.chunks.pop_front();
+                }
+                else
+                {
+                    chunk = queue.chunks.back();
+                    queue.chunks.pop_back();
+                }
+
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    auto work = [&](std::size_t self)
+    {
+        Arena arena;
+        std::size_t c;
+
+        while (take(self, c))
+        {
+            std::ostringstream output;
+            std::ostringstream errors;
+
+            std::size_t first = c * RECORDS_PER_CHUNK;
+            std::size_t last = std::min(first + RECORDS_PER_CHUNK, records.size());
+
+            for (std::size_t i = first; i < last; i++)
+            {
+                RecordBuffer buffer(records[i].begin, records[i].end);
+                std::istream in(&buffer);
+                std::ostringstream error;
+
+                Execution execution(m_program, in, output, error, &arena);
+                execution.setSeed(seed + i);
+                execution.setLimits(m_limits);
+
+                bool isRun;
+
+                // One bad record fails alone.
+                try
+                {
+                    isRun = execution.run();
+                }
+                catch (const std::exception&)
+                {
+                    isRun = false;
+                    error << "Internal error!\n";
+                }
+
+                if (!isRun)
+                    failed++;
+
+                if (0 != error.tellp())
+                    errors << "Record " << (i + 1) << ": " << error.str();
+            }
+
+            std::lock_guard<std::mutex> lock(flushMutex);
+
+            chunks[c].output = output.str();
+            chunks[c].errors = errors.str();
+            chunks[c].isDone = true;
+
+            while ((flushed < totalChunks) && chunks[flushed].isDone)
+            {
+                out << chunks[flushed].output;
+                err << chunks[flushed].errors;
+
+                std::string().swap(chunks[flushed].output);
+                std::string().swap(chunks[flushed].errors);
+                flushed++;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 1; i < totalThreads; i++)
+        threads.push_back(std::thread(work, i));
+
+    work(0);
+
+    for (std::size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    out.flush();
+    return failed;
+}
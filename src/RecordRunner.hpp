@@ -0,0 +1,56 @@
+#ifndef RECORD_RUNNER_HPP_INCLUDED
+#define RECORD_RUNNER_HPP_INCLUDED
+
+#include <cstdint>
+#include <ostream>
+#include "Governor.hpp"
+#include "Program.hpp"
+
+// Runs one program once per record of a large input, typically a mapped
+// file, with each record as the INPUT stream of its own fresh Execution.
+// Records are lines; a carriage return before the line feed is dropped.
+//
+// Records are handed out in chunks. Each thread starts with an equal,
+// contiguous share of the chunks and works through it from the front;
+// threads that run out steal from the back of the others. Output is
+// written in record order as soon as all earlier chunks are done.
+class RecordRunner
+{
+public:
+
+    static const std::size_t RECORDS_PER_CHUNK = 256;
+
+    // totalThreads of zero uses one thread per hardware thread.
+    explicit RecordRunner(const Program& program, unsigned totalThreads = 0);
+
+    // Record i starts RND from seed + i.
+    void setSeed(std::uint64_t seed) { m_seed = seed; m_isSeeded = true; }
+
+    // Applied to each run on its own.
+    void setLimits(const Governor::Limits& limits) { m_limits = limits; }
+
+    unsigned getTotalThreads() const { return m_totalThreads; }
+
+    // Writes what the program printed for every record to out and its
+    // errors, tagged with the record number, to err. Returns the number
+    // of records the program failed on.
+    std::size_t run(
+        const char*   data,
+        std::size_t   size,
+        std::ostream& out,
+        std::ostream& err) const;
+
+private:
+
+    RecordRunner(const RecordRunner&);
+    RecordRunner& operator =(const RecordRunner&);
+
+    const Program& m_program;
+    unsigned       m_totalThreads;
+    bool           m_isSeeded;
+    std::uint64_t  m_seed;
+
+    Governor::Limits m_limits;
+};
+
+#endif // RECORD_RUNNER_HPP_INCLUDED
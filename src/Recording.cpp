@@ -0,0 +1,145 @@
+#include <cstring>
+#include <fstream>
+#include "Checkpoint.hpp"
+#include "Program.hpp"
+#include "Recording.hpp"
+
+// Encoded as checkpoints are: the program's hash, the seeds, the input
+// text and the call results, each list after its length.
+static const char RECORDING_MAGIC[8] = { 'C', 'I', 'T', 'R', 'E', 'C', 'O', 'R' };
+static const std::uint64_t RECORDING_VERSION = 1;
+
+void Recording::clear()
+{
+    m_seeds.clear();
+    m_input.clear();
+    m_calls.clear();
+    rewind();
+}
+
+
+void Recording::putCall(std::int64_t status, const std::string& output)
+{
+    Call call;
+    call.status = status;
+    call.output = output;
+    m_calls.push_back(call);
+}
+
+
+bool Recording::getSeed(std::uint64_t& seed)
+{
+    if (m_nextSeed >= m_seeds.size())
+        return false;
+
+    seed = m_seeds[m_nextSeed++];
+    return true;
+}
+
+
+bool Recording::getCall(std::int64_t& status, std::string& output)
+{
+    if (m_nextCall >= m_calls.size())
+        return false;
+
+    status = m_calls[m_nextCall].status;
+    output = m_calls[m_nextCall].output;
+    m_nextCall++;
+    return true;
+}
+
+
+bool Recording::write(const std::string& fileName, const Program& program, std::ostream& err) const
+{
+    std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    CheckpointWriter writer(file);
+
+    file.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    writer.putInteger(RECORDING_VERSION);
+    writer.putInteger(program.getHash());
+
+    writer.putInteger(m_seeds.size());
+
+    for (std::size_t i = 0; i < m_seeds.size(); i++)
+        writer.putInteger(m_seeds[i]);
+
+    writer.putString(m_input);
+    writer.putInteger(m_calls.size());
+
+    for (std::size_t i = 0; i < m_calls.size(); i++)
+    {
+        writer.putInteger(static_cast<std::uint64_t>(m_calls[i].status));
+        writer.putString(m_calls[i].output);
+    }
+
+    file.close();
+
+    if (file.fail())
+    {
+        err << "Cannot write recording \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+// Read aside, so that a damaged file changes nothing.
+bool Recording::read(std::istream& file, const Program& program, std::ostream& err)
+{
+    char magic[sizeof(RECORDING_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+
+    CheckpointReader reader(file);
+
+    std::uint64_t version = reader.getInteger();
+    std::uint64_t hash = reader.getInteger();
+
+    if (!reader.isGood() ||
+        (0 != std::memcmp(magic, RECORDING_MAGIC, sizeof(magic))) ||
+        (RECORDING_VERSION != version))
+    {
+        err << "Bad recording!\n";
+        return false;
+    }
+
+    if (program.getHash() != hash)
+    {
+        err << "Recording is of another program!\n";
+        return false;
+    }
+
+    std::vector<std::uint64_t> seeds;
+    std::string                input;
+    std::vector<Call>          calls;
+
+    std::uint64_t total = reader.getInteger();
+
+    for (std::uint64_t i = 0; (i < total) && reader.isGood(); i++)
+        seeds.push_back(reader.getInteger());
+
+    reader.getString(input);
+    total = reader.getInteger();
+
+    for (std::uint64_t i = 0; (i < total) && reader.isGood(); i++)
+    {
+        Call call;
+        call.status = static_cast<std::int64_t>(reader.getInteger());
+        reader.getString(call.output);
+        calls.push_back(call);
+    }
+
+    if (!reader.isGood())
+    {
+        err << "Bad recording!\n";
+        return false;
+    }
+
+    m_seeds.swap(seeds);
+    m_input.swap(input);
+    m_calls.swap(calls);
+    rewind();
+
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef RECORDING_HPP_INCLUDED
+#define RECORDING_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Program;
+
+// What a run took from outside and could take differently the next time:
+// the seeds RND started from, the text INPUT read, and what SHELL, EXEC,
+// SPAWN and WAIT returned. A run given the recording of an earlier run of
+// the same program to replay takes the same values from it, in the same
+// order, and so goes down the same path; see Execution::setRecorder() and
+// Execution::setReplay().
+class Recording
+{
+public:
+
+    Recording() : m_nextSeed(0), m_nextCall(0) {}
+
+    // Forgets everything recorded.
+    void clear();
+
+    // A replay starts over from the first values.
+    void rewind() { m_nextSeed = 0, m_nextCall = 0; }
+
+    void putSeed(std::uint64_t seed) { m_seeds.push_back(seed); }
+    void putInput(const char* data, std::size_t size) { m_input.append(data, size); }
+    void putCall(std::int64_t status, const std::string& output);
+
+    // False once everything recorded has been taken.
+    bool getSeed(std::uint64_t& seed);
+    bool getCall(std::int64_t& status, std::string& output);
+
+    // All the text INPUT read, in order.
+    const std::string& getInput() const { return m_input; }
+
+    // The file belongs to the program; errors are reported to err.
+    bool write(const std::string& fileName, const Program& program, std::ostream& err) const;
+    bool read(std::istream& file, const Program& program, std::ostream& err);
+
+private:
+
+    struct Call
+    {
+        std::int64_t status;
+        std::string  output;
+    };
+
+    std::vector<std::uint64_t> m_seeds;
+    std::string                m_input;
+    std::vector<Call>          m_calls;
+
+    std::size_t m_nextSeed;
+    std::size_t m_nextCall;
+};
+
+#endif // RECORDING_HPP_INCLUDED
@@ -0,0 +1,242 @@
+#ifndef RING_HPP_INCLUDED
+#define RING_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free queues over a ring of slots. Capacities are rounded up
+// to a power of two. push() and pop() move the value and fail rather than
+// wait; size() is only a snapshot.
+
+// One producer thread and one consumer thread at a time. Each side keeps
+// a copy of the other's position and only reloads it when the ring looks
+// full or empty.
+template <typename T>
+class SpscRing
+{
+public:
+
+    explicit SpscRing(std::size_t capacity)
+        : m_mask(roundUp(capacity) - 1)
+        , m_slots(new T[m_mask + 1])
+        , m_tail(0)
+        , m_headCache(0)
+        , m_head(0)
+        , m_tailCache(0)
+    {
+    }
+
+    bool push(T& value)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_headCache > m_mask)
+        {
+            m_headCache = m_head.load(std::memory_order_acquire);
+
+            if (tail - m_headCache > m_mask)
+                return false;
+        }
+
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value)
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tailCache)
+        {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+
+            if (head == m_tailCache)
+                return false;
+        }
+
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The head is read first so that the result never wraps below zero.
+    std::size_t size() const
+    {
+        std::size_t head = m_head.load(std::memory_order_seq_cst);
+        return m_tail.load(std::memory_order_seq_cst) - head;
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+
+    // Padding that keeps the producer's and the consumer's positions on
+    // cache lines of their own.
+    static const std::size_t CACHE_LINE = 64;
+
+    SpscRing(const SpscRing&);
+    SpscRing& operator =(const SpscRing&);
+
+    static std::size_t roundUp(std::size_t capacity)
+    {
+        std::size_t result = 1;
+
+        while (result < capacity)
+            result <<= 1;
+
+        return result;
+    }
+
+    const std::size_t    m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    char m_pad0[CACHE_LINE];
+
+    std::atomic<std::size_t> m_tail;       // written by the producer
+    std::size_t              m_headCache;
+
+    char m_pad1[CACHE_LINE];
+
+    std::atomic<std::size_t> m_head;       // written by the consumer
+    std::size_t              m_tailCache;
+
+    char m_pad2[CACHE_LINE];
+};
+
+
+// Any number of producers and consumers (D. Vyukov's bounded queue). Each
+// slot carries a sequence number that tells whether it is free for the
+// producer or filled for the consumer at a given position, so claiming a
+// position is a single compare-and-swap.
+template <typename T>
+class MpmcRing
+{
+public:
+
+    explicit MpmcRing(std::size_t capacity)
+        : m_mask(roundUp(capacity) - 1)
+        , m_slots(new Slot[m_mask + 1])
+        , m_tail(0)
+        , m_head(0)
+    {
+        for (std::size_t i = 0; i <= m_mask; i++)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(T& value)
+    {
+        std::size_t position = m_tail.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true)
+        {
+            slot = &m_slots[position & m_mask];
+
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (0 == difference)
+            {
+                if (m_tail.compare_exchange_weak(
+                    position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::move(value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value)
+    {
+        std::size_t position = m_head.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true)
+        {
+            slot = &m_slots[position & m_mask];
+
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference =
+                static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+            if (0 == difference)
+            {
+                if (m_head.compare_exchange_weak(
+                    position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(slot->value);
+        slot->sequence.store(position + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The head is read first so that the result never wraps below zero.
+    std::size_t size() const
+    {
+        std::size_t head = m_head.load(std::memory_order_seq_cst);
+        return m_tail.load(std::memory_order_seq_cst) - head;
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+
+    static const std::size_t CACHE_LINE = 64;
+
+    MpmcRing(const MpmcRing&);
+    MpmcRing& operator =(const MpmcRing&);
+
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        T                        value;
+    };
+
+    static std::size_t roundUp(std::size_t capacity)
+    {
+        std::size_t result = 1;
+
+        while (result < capacity)
+            result <<= 1;
+
+        return result;
+    }
+
+    const std::size_t       m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    char m_pad0[CACHE_LINE];
+
+    std::atomic<std::size_t> m_tail;
+
+    char m_pad1[CACHE_LINE];
+
+    std::atomic<std::size_t> m_head;
+
+    char m_pad2[CACHE_LINE];
+};
+
+#endif // RING_HPP_INCLUDED
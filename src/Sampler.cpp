@@ -0,0 +1,233 @@
+#include <cctype>
+#include <ostream>
+#include "Program.hpp"
+#include "Sampler.hpp"
+
+#ifdef _WIN32
+#include <atomic>
+#include <chrono>
+#include <thread>
+#else
+#include <sys/time.h>
+#endif
+
+volatile std::sig_atomic_t Sampler::s_ticks = 0;
+
+#ifdef _WIN32
+
+// There is no SIGPROF on Windows, so a thread wakes up at the sample rate
+// instead. It measures wall clock rather than CPU time.
+struct Sampler::Timer
+{
+    std::atomic<bool> stop;
+    std::thread       thread;
+};
+
+
+bool Sampler::start(std::ostream&)
+{
+    if (m_running)
+        return true;
+
+    m_timer = new Timer;
+    m_timer->stop = false;
+
+    Timer* timer = m_timer;
+    std::chrono::microseconds period(1000000 / m_rate);
+
+    m_timer->thread = std::thread([timer, period]()
+        {
+            while (!timer->stop)
+            {
+                std::this_thread::sleep_for(period);
+                s_ticks = s_ticks + 1;
+            }
+        });
+
+    m_running = true;
+    return true;
+}
+
+
+void Sampler::stop()
+{
+    if (!m_running)
+        return;
+
+    m_timer->stop = true;
+    m_timer->thread.join();
+
+    delete m_timer;
+    m_timer = nullptr;
+    m_running = false;
+}
+
+#else
+
+struct Sampler::Timer
+{
+    struct sigaction previous;
+};
+
+
+void Sampler::tick(int)
+{
+    // Nothing else is safe here; the interpreter picks the ticks up
+    // between lines.
+    Sampler::s_ticks = Sampler::s_ticks + 1;
+}
+
+
+bool Sampler::start(std::ostream& err)
+{
+    if (m_running)
+        return true;
+
+    m_timer = new Timer;
+
+    struct sigaction action = {};
+    action.sa_handler = tick;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (0 != ::sigaction(SIGPROF, &action, &m_timer->previous))
+    {
+        err << "Cannot install the sampling signal handler!\n";
+        delete m_timer;
+        m_timer = nullptr;
+        return false;
+    }
+
+    // A period of a whole second has to be given in seconds.
+    const unsigned period = 1000000 / m_rate;
+
+    struct itimerval interval = {};
+    interval.it_interval.tv_sec = period / 1000000;
+    interval.it_interval.tv_usec = period % 1000000;
+    interval.it_value = interval.it_interval;
+
+    if (0 != ::setitimer(ITIMER_PROF, &interval, nullptr))
+    {
+        err << "Cannot start the sampling timer!\n";
+        ::sigaction(SIGPROF, &m_timer->previous, nullptr);
+        delete m_timer;
+        m_timer = nullptr;
+        return false;
+    }
+
+    m_running = true;
+    return true;
+}
+
+
+void Sampler::stop()
+{
+    if (!m_running)
+        return;
+
+    struct itimerval interval = {};
+    ::setitimer(ITIMER_PROF, &interval, nullptr);
+    ::sigaction(SIGPROF, &m_timer->previous, nullptr);
+
+    delete m_timer;
+    m_timer = nullptr;
+    m_running = false;
+}
+
+#endif
+
+
+Sampler::Sampler(unsigned rate)
+    : m_rate((0 == rate) ? 1 : ((rate > 1000000) ? 1000000 : rate))
+    , m_running(false)
+    , m_timer(nullptr)
+{
+}
+
+
+Sampler::~Sampler()
+{
+    stop();
+}
+
+
+void Sampler::record(
+    std::size_t        line,
+    const std::size_t* callStack,
+    std::size_t        depth)
+{
+    // A tick that arrives between the read and the reset is lost, which
+    // is no worse than one that arrives a moment later.
+    std::sig_atomic_t ticks = s_ticks;
+    s_ticks = 0;
+
+    if (0 == ticks)
+        return;
+
+    // The call stack holds return lines; the GOSUB itself is the line
+    // before each of them.
+    m_stack.clear();
+
+    for (std::size_t i = 0; i < depth; i++)
+        m_stack.push_back(callStack[i] - 1);
+
+    m_stack.push_back(line);
+
+    m_samples[m_stack] += static_cast<unsigned long>(ticks);
+}
+
+
+void Sampler::report(
+    std::ostream&      stream,
+    const Program& program) const
+{
+    std::vector<std::string> frames(program.getTotalLines());
+
+    // Frames are named "<line number> <source>"; the folded format splits
+    // frames at semicolons and the count off at the last space, so
+    // semicolons become commas and runs of blanks collapse.
+    auto frame = [&](std::size_t line) -> const std::string&
+    {
+        std::string& name = frames[line];
+
+        if (name.empty())
+        {
+            name = std::to_string(program.getLineNumber(line));
+
+            bool blank = true;
+
+            for (const char* c = program.getSourceLine(line); *c; c++)
+            {
+                if (std::isspace(static_cast<unsigned char>(*c)))
+                {
+                    blank = true;
+                }
+                else
+                {
+                    if (blank)
+                        name += ' ';
+
+                    name += (';' == *c) ? ',' : *c;
+                    blank = false;
+                }
+            }
+        }
+
+        return name;
+    };
+
+    for (auto i = m_samples.begin(); i != m_samples.end(); ++i)
+    {
+        const std::vector<std::size_t>& stack = i->first;
+
+        for (std::size_t k = 0; k < stack.size(); k++)
+        {
+            if (0 != k)
+                stream << ';';
+
+            stream << frame(stack[k]);
+        }
+
+        stream << ' ' << i->second << '\n';
+    }
+}
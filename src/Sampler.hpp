@@ -0,0 +1,74 @@
+#ifndef SAMPLER_HPP_INCLUDED
+#define SAMPLER_HPP_INCLUDED
+
+#include <csignal>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Program;
+
+// Statistical profiler. A timer ticks at the requested rate of consumed
+// CPU time (SIGPROF where there is one, a timer thread elsewhere) and only
+// bumps a counter; the interpreter checks the counter between lines and
+// charges the pending ticks to the line it just ran and to the chain of
+// GOSUBs that led there.
+//
+// The result is written as folded stacks, one per line, the format that
+// flame graph tools take as input. Stacks are sorted, so two runs of the
+// same program differ only in their counts.
+class Sampler
+{
+public:
+
+    static const unsigned DEFAULT_RATE = 997;
+
+    // Rates are brought into 1 to MAX_RATE, as the timer counts whole
+    // microseconds.
+    static const unsigned MAX_RATE = 1000000;
+
+    explicit Sampler(unsigned rate = DEFAULT_RATE);
+    ~Sampler();
+
+    // Only one sampler can be running at a time. Failures are reported
+    // to err.
+    bool start(std::ostream& err);
+    void stop();
+
+    static bool pending()
+    {
+        return 0 != s_ticks;
+    }
+
+    void record(
+        std::size_t        line,
+        const std::size_t* callStack,
+        std::size_t        depth);
+
+    void report(std::ostream& stream, const Program& program) const;
+
+    unsigned getRate() const { return m_rate; }
+
+private:
+
+    Sampler(const Sampler&);
+    Sampler& operator =(const Sampler&);
+
+    static volatile std::sig_atomic_t s_ticks;
+
+    static void tick(int);
+
+    unsigned m_rate;
+    bool     m_running;
+
+    // Stack of line indices, outermost first -> ticks
+    std::map<std::vector<std::size_t>, unsigned long> m_samples;
+    std::vector<std::size_t>                          m_stack;
+
+    struct Timer;
+    Timer* m_timer;
+};
+
+#endif // SAMPLER_HPP_INCLUDED
@@ -0,0 +1,273 @@
+#include <exception>
+#include "Scheduler.hpp"
+
+Scheduler::Scheduler(unsigned totalThreads, unsigned totalShellThreads)
+    : m_nextId(0)
+    , m_isSeeded(false)
+    , m_seed(0)
+    , m_isStopping(false)
+{
+    if (0 == totalThreads)
+        totalThreads = std::thread::hardware_concurrency();
+
+    if (0 == totalThreads)
+        totalThreads = 1;
+
+    if (0 == totalShellThreads)
+        totalShellThreads = 1;
+
+    for (unsigned i = 0; i < totalThreads; i++)
+        m_threads.push_back(std::thread(&Scheduler::work, this));
+
+    for (unsigned i = 0; i < totalShellThreads; i++)
+        m_threads.push_back(std::thread(&Scheduler::runShell, this));
+}
+
+
+Scheduler::~Scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+
+    m_ready.notify_all();
+    m_shellReady.notify_all();
+
+    for (std::size_t i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+
+    // Takes the parked runs off their channels while the queues they
+    // would be woken into still exist.
+    m_tasks.clear();
+}
+
+
+void Scheduler::setLimits(const Governor::Limits& limits)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_limits = limits;
+}
+
+
+Scheduler::Id Scheduler::spawn(
+    const Program& program,
+    std::ostream&  out,
+    std::ostream&  err,
+    Channels*      channels)
+{
+    std::unique_ptr<Task> task(new Task(*this, program, out, err));
+
+    task->execution.setChannels(channels);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Id id = m_nextId++;
+
+    if (m_isSeeded)
+        task->execution.setSeed(m_seed + id);
+
+    task->execution.setLimits(m_limits);
+    task->execution.start();
+
+    m_readyTasks.push_back(task.get());
+    m_tasks[id] = std::move(task);
+
+    m_ready.notify_one();
+    return id;
+}
+
+
+void Scheduler::feed(Id id, const std::string& text)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto i = m_tasks.find(id);
+    if (m_tasks.end() == i)
+        return;
+
+    Task& task = *i->second;
+    task.input.append(text);
+
+    if (task.isWaiting)
+    {
+        task.isWaiting = false;
+        m_readyTasks.push_back(&task);
+        m_ready.notify_one();
+    }
+}
+
+
+void Scheduler::closeInput(Id id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto i = m_tasks.find(id);
+    if (m_tasks.end() == i)
+        return;
+
+    Task& task = *i->second;
+    task.isInputClosed = true;
+
+    if (task.isWaiting)
+    {
+        task.isWaiting = false;
+        m_readyTasks.push_back(&task);
+        m_ready.notify_one();
+    }
+}
+
+
+bool Scheduler::wait(Id id)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto i = m_tasks.find(id);
+    if (m_tasks.end() == i)
+        return false;
+
+    Task& task = *i->second;
+
+    while (!task.isDone)
+        m_done.wait(lock);
+
+    bool isDone = !task.isFailed &&
+        (Execution::STATUS_FINISHED == task.execution.getStatus());
+
+    m_tasks.erase(i);
+    return isDone;
+}
+
+
+// A task is in at most one queue or on one thread at a time, and only
+// changes hands under the lock, so its execution needs no lock of its own.
+void Scheduler::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        while (!m_isStopping && m_readyTasks.empty())
+            m_ready.wait(lock);
+
+        if (m_isStopping)
+            return;
+
+        Task& task = *m_readyTasks.front();
+        m_readyTasks.pop_front();
+
+        if (!task.input.empty())
+        {
+            task.execution.provideInput(task.input);
+            task.input.clear();
+        }
+
+        if (task.isInputClosed)
+            task.execution.closeInput();
+
+        lock.unlock();
+        Execution::Status status;
+
+        // An exception fails the run that threw it and no other.
+        try
+        {
+            status = task.execution.resume(TIME_SLICE);
+        }
+        catch (const std::exception&)
+        {
+            task.err << "Internal error!\n";
+            task.isFailed = true;
+            status = Execution::STATUS_FAILED;
+        }
+
+        // Once parked the task belongs to the channel, which may wake it
+        // on another thread straight away.
+        if ((Execution::STATUS_WAITING_CHANNEL == status) &&
+            task.execution.getWaitChannel()->park(
+                &task, task.execution.isWaitingToSend()))
+        {
+            lock.lock();
+            continue;
+        }
+
+        lock.lock();
+
+        switch (status)
+        {
+        case Execution::STATUS_READY:
+        case Execution::STATUS_WAITING_CHANNEL:
+            m_readyTasks.push_back(&task);
+            break;
+
+        case Execution::STATUS_WAITING_INPUT:
+            // Input fed while it ran has not been looked at yet.
+            if (!task.input.empty() || task.isInputClosed)
+                m_readyTasks.push_back(&task);
+            else
+                task.isWaiting = true;
+            break;
+
+        case Execution::STATUS_WAITING_SHELL:
+            m_shellTasks.push_back(&task);
+            m_shellReady.notify_one();
+            break;
+
+        default:
+            task.isDone = true;
+            m_done.notify_all();
+            break;
+        }
+    }
+}
+
+
+void Scheduler::requeue(Task& task)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_readyTasks.push_back(&task);
+    m_ready.notify_one();
+}
+
+
+void Scheduler::runShell()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        while (!m_isStopping && m_shellTasks.empty())
+            m_shellReady.wait(lock);
+
+        if (m_isStopping)
+            return;
+
+        Task& task = *m_shellTasks.front();
+        m_shellTasks.pop_front();
+
+        lock.unlock();
+
+        try
+        {
+            task.execution.completeCall();
+        }
+        catch (const std::exception&)
+        {
+            task.err << "Internal error!\n";
+            task.isFailed = true;
+        }
+
+        lock.lock();
+
+        if (task.isFailed)
+        {
+            task.isDone = true;
+            m_done.notify_all();
+        }
+        else
+        {
+            m_readyTasks.push_back(&task);
+            m_ready.notify_one();
+        }
+    }
+}
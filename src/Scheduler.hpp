@@ -0,0 +1,130 @@
+#ifndef SCHEDULER_HPP_INCLUDED
+#define SCHEDULER_HPP_INCLUDED
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Channel.hpp"
+#include "Execution.hpp"
+#include "Governor.hpp"
+#include "Program.hpp"
+
+// Runs many resumable executions on a few threads. A run that waits for
+// INPUT, a channel or a child process gives its thread to the next ready
+// run: input arrives through feed(), runs waiting on a channel are parked
+// on it until it wakes them, and SHELL, EXEC and WAIT calls block threads
+// of their own so that a slow command only holds up the run that started
+// it. Runs that keep busy are rotated every TIME_SLICE lines.
+class Scheduler
+{
+public:
+
+    typedef std::size_t Id;
+
+    static const std::size_t TIME_SLICE = 4096;
+    static const unsigned    DEFAULT_SHELL_THREADS = 4;
+
+    // totalThreads of zero uses one thread per hardware thread.
+    explicit Scheduler(
+        unsigned totalThreads      = 0,
+        unsigned totalShellThreads = DEFAULT_SHELL_THREADS);
+
+    // Abandons the runs nobody has waited for.
+    ~Scheduler();
+
+    // Run n starts RND from seed + n, counting from zero.
+    void setSeed(std::uint64_t seed) { m_seed = seed; m_isSeeded = true; }
+
+    // Applied to each run spawned from then on, on its own. A run that
+    // hits one fails; the time it spends parked counts as real time but
+    // not as CPU time.
+    void setLimits(const Governor::Limits& limits);
+
+    // Starts a run of program, which must outlive it. The run prints to
+    // out and reports errors to err; no other run may share them. Channels
+    // are looked up in channels, or in the default registry.
+    Id spawn(
+        const Program& program,
+        std::ostream&  out,
+        std::ostream&  err,
+        Channels*      channels = nullptr);
+
+    // Text for INPUT statements; see Execution::provideInput().
+    void feed(Id id, const std::string& text);
+    void closeInput(Id id);
+
+    // Blocks until the run has ended, then forgets it. True when it ran to
+    // its end without an error.
+    bool wait(Id id);
+
+private:
+
+    Scheduler(const Scheduler&);
+    Scheduler& operator =(const Scheduler&);
+
+    struct Task : Channel::Waiter
+    {
+        Task(
+            Scheduler&     owner,
+            const Program& program,
+            std::ostream&  out,
+            std::ostream&  err)
+            : scheduler(owner)
+            , execution(program, std::cin, out, err)
+            , err(err)
+            , isInputClosed(false)
+            , isWaiting(false)
+            , isFailed(false)
+            , isDone(false)
+        {
+        }
+
+        ~Task()
+        {
+            if (Execution::STATUS_WAITING_CHANNEL == execution.getStatus())
+                execution.getWaitChannel()->cancel(this);
+        }
+
+        void wake() { scheduler.requeue(*this); }
+
+        Scheduler&  scheduler;
+        Execution     execution;
+        std::ostream& err;
+        std::string   input;        // fed but not yet handed over
+        bool          isInputClosed;
+        bool          isWaiting;    // parked on INPUT
+        bool          isFailed;     // stopped by an internal error
+        bool          isDone;
+    };
+
+    void work();
+    void runShell();
+    void requeue(Task& task);
+
+    std::mutex              m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_shellReady;
+    std::condition_variable m_done;
+
+    std::map<Id, std::unique_ptr<Task>> m_tasks;
+    std::deque<Task*>                   m_readyTasks;
+    std::deque<Task*>                   m_shellTasks;
+
+    Id            m_nextId;
+    bool          m_isSeeded;
+    std::uint64_t m_seed;
+    bool          m_isStopping;
+
+    Governor::Limits m_limits;
+
+    std::vector<std::thread> m_threads;
+};
+
+#endif // SCHEDULER_HPP_INCLUDED
@@ -0,0 +1,442 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include "Execution.hpp"
+#include "Server.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// A request is the file name and the size of the input, each on a line of
+// its own, followed by the input. The reply is a line with 1 or 0 for
+// whether the run finished and the sizes of the output and the errors,
+// followed by the output and the errors.
+
+Server::Server(unsigned totalThreads, std::size_t cacheCapacity)
+    : m_totalThreads(totalThreads)
+    , m_isSeeded(false)
+    , m_seed(0)
+    , m_cache(cacheCapacity)
+    , m_isStopping(false)
+    , m_listener(-1)
+{
+    if (0 == m_totalThreads)
+        m_totalThreads = std::thread::hardware_concurrency();
+
+    if (0 == m_totalThreads)
+        m_totalThreads = 1;
+}
+
+
+#ifdef _WIN32
+
+bool Server::run(const std::string&, std::ostream& err)
+{
+    err << "Server mode is not supported on this system!\n";
+    return false;
+}
+
+
+void Server::stop()
+{
+}
+
+
+bool Server::request(
+    const std::string&,
+    const std::string&,
+    const std::string&,
+    std::ostream&,
+    std::ostream& err)
+{
+    err << "Server mode is not supported on this system!\n";
+    return false;
+}
+
+
+#else
+
+static const std::size_t MAX_LINE_SIZE = PATH_MAX + 64;
+
+static bool fillAddress(const std::string& socketPath, sockaddr_un& address)
+{
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path))
+        return false;
+
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+}
+
+
+// Sockets are not to be inherited by the children that SHELL starts.
+static int openSocket()
+{
+#ifdef __linux__
+    return ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
+    int result = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (-1 != result)
+        ::fcntl(result, F_SETFD, FD_CLOEXEC);
+
+    return result;
+#endif
+}
+
+
+static int acceptSocket(int listener)
+{
+#ifdef __linux__
+    return ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+    int result = ::accept(listener, nullptr, nullptr);
+
+    if (-1 != result)
+        ::fcntl(result, F_SETFD, FD_CLOEXEC);
+
+    return result;
+#endif
+}
+
+
+static bool sendAll(int connection, const char* data, std::size_t size)
+{
+    while (0 != size)
+    {
+        ssize_t sent = ::write(connection, data, size);
+
+        if (sent < 0)
+        {
+            if (EINTR == errno)
+                continue;
+
+            return false;
+        }
+
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+
+    return true;
+}
+
+
+// Reads until the buffer holds at least size bytes.
+static bool fill(int connection, std::string& buffer, std::size_t size)
+{
+    char chunk[16384];
+
+    while (buffer.size() < size)
+    {
+        ssize_t received = ::read(connection, chunk, sizeof(chunk));
+
+        if (received < 0)
+        {
+            if (EINTR == errno)
+                continue;
+
+            return false;
+        }
+
+        if (0 == received)
+            return false;
+
+        buffer.append(chunk, static_cast<std::size_t>(received));
+    }
+
+    return true;
+}
+
+
+// Takes a line off the front of the buffer, reading more as needed.
+static bool takeLine(int connection, std::string& buffer, std::string& line)
+{
+    std::size_t end;
+
+    while (std::string::npos == (end = buffer.find('\n')))
+    {
+        if ((buffer.size() > MAX_LINE_SIZE) ||
+            !fill(connection, buffer, buffer.size() + 1))
+            return false;
+    }
+
+    line.assign(buffer, 0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+
+// Takes a size from the front of the buffer.
+static bool takeSize(int connection, std::string& buffer, std::size_t& size)
+{
+    std::string line;
+
+    if (!takeLine(connection, buffer, line) || line.empty())
+        return false;
+
+    char* end;
+    errno = 0;
+    unsigned long long value = std::strtoull(line.c_str(), &end, 10);
+
+    if ((0 != errno) || ('\0' != *end))
+        return false;
+
+    size = static_cast<std::size_t>(value);
+    return true;
+}
+
+
+bool Server::run(const std::string& socketPath, std::ostream& err)
+{
+    sockaddr_un address;
+
+    if (!fillAddress(socketPath, address))
+    {
+        err << "Socket path is too long!\n";
+        return false;
+    }
+
+    int listener = openSocket();
+
+    if (-1 == listener)
+    {
+        err << "Cannot create socket!\n";
+        return false;
+    }
+
+    ::unlink(socketPath.c_str());
+
+    if ((0 != ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address))) ||
+        (0 != ::listen(listener, SOMAXCONN)))
+    {
+        err << "Cannot listen on \"" << socketPath << "\"!\n";
+        ::close(listener);
+        return false;
+    }
+
+    // A client that hangs up early must not take the server down.
+    ::signal(SIGPIPE, SIG_IGN);
+
+    m_listener = listener;
+
+    for (unsigned i = 0; i < m_totalThreads; i++)
+        m_threads.push_back(std::thread(&Server::work, this));
+
+    while (!m_isStopping)
+    {
+        int connection = acceptSocket(listener);
+
+        if (-1 == connection)
+        {
+            // Out of descriptors, most likely; the requests under way
+            // will free some.
+            if ((EINTR != errno) && !m_isStopping)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_connections.push_back(connection);
+        m_ready.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready.notify_all();
+    }
+
+    for (std::size_t i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+
+    m_threads.clear();
+
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+    return true;
+}
+
+
+// Shutting the listener down wakes the accept() it is blocked in.
+void Server::stop()
+{
+    m_isStopping = true;
+
+    int listener = m_listener;
+
+    if (-1 != listener)
+        ::shutdown(listener, SHUT_RDWR);
+}
+
+
+// Connections still queued when the server stops are served all the same.
+void Server::work()
+{
+    Arena arena;
+
+    while (true)
+    {
+        int connection;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while (m_connections.empty() && !m_isStopping)
+                m_ready.wait(lock);
+
+            if (m_connections.empty())
+                return;
+
+            connection = m_connections.front();
+            m_connections.pop_front();
+        }
+
+        serve(connection, arena);
+        ::close(connection);
+    }
+}
+
+
+void Server::serve(int connection, Arena& arena)
+{
+    std::string buffer;
+    std::string fileName;
+    std::size_t inputSize;
+
+    if (!takeLine(connection, buffer, fileName) ||
+        !takeSize(connection, buffer, inputSize) ||
+        !fill(connection, buffer, inputSize))
+        return;
+
+    buffer.resize(inputSize);
+
+    std::istringstream in(buffer);
+    std::ostringstream out;
+    std::ostringstream err;
+
+    bool isDone = false;
+
+    // Whatever one script does, the server goes on serving the others.
+    try
+    {
+        std::shared_ptr<const Program> program = m_cache.get(fileName, err);
+
+        if (nullptr != program)
+        {
+            Execution execution(*program, in, out, err, &arena);
+            execution.setLimits(m_limits);
+
+            if (m_isSeeded)
+                execution.setSeed(m_seed);
+
+            isDone = execution.run();
+        }
+    }
+    catch (const std::exception&)
+    {
+        isDone = false;
+        err << "Internal error!\n";
+    }
+
+    std::string output = out.str();
+    std::string errors = err.str();
+
+    std::ostringstream header;
+    header << (isDone ? 1 : 0) << ' ' << output.size() << ' ' << errors.size() << '\n';
+
+    std::string reply = header.str();
+
+    sendAll(connection, reply.data(), reply.size()) &&
+        sendAll(connection, output.data(), output.size()) &&
+        sendAll(connection, errors.data(), errors.size());
+}
+
+
+bool Server::request(
+    const std::string& socketPath,
+    const std::string& fileName,
+    const std::string& input,
+    std::ostream&      out,
+    std::ostream&      err)
+{
+    sockaddr_un address;
+
+    if (!fillAddress(socketPath, address))
+    {
+        err << "Socket path is too long!\n";
+        return false;
+    }
+
+    // The server has a current directory of its own.
+    char path[PATH_MAX];
+
+    if (nullptr == ::realpath(fileName.c_str(), path))
+    {
+        err << "Cannot open \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    int connection = openSocket();
+
+    if ((-1 == connection) ||
+        (0 != ::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address))))
+    {
+        err << "Cannot connect to \"" << socketPath << "\"!\n";
+
+        if (-1 != connection)
+            ::close(connection);
+
+        return false;
+    }
+
+    std::ostringstream header;
+    header << path << '\n' << input.size() << '\n';
+
+    std::string request = header.str();
+    std::string buffer;
+    std::string line;
+
+    bool isReplied =
+        sendAll(connection, request.data(), request.size()) &&
+        sendAll(connection, input.data(), input.size()) &&
+        takeLine(connection, buffer, line);
+
+    int isDone = 0;
+    std::size_t outputSize = 0;
+    std::size_t errorsSize = 0;
+
+    if (isReplied)
+    {
+        std::istringstream sizes(line);
+        isReplied = (sizes >> isDone >> outputSize >> errorsSize) &&
+            fill(connection, buffer, outputSize + errorsSize);
+    }
+
+    ::close(connection);
+
+    if (!isReplied)
+    {
+        err << "No reply from \"" << socketPath << "\"!\n";
+        return false;
+    }
+
+    out.write(buffer.data(), static_cast<std::streamsize>(outputSize));
+    err.write(buffer.data() + outputSize, static_cast<std::streamsize>(errorsSize));
+
+    return 0 != isDone;
+}
+
+#endif
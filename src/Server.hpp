@@ -0,0 +1,88 @@
+#ifndef SERVER_HPP_INCLUDED
+#define SERVER_HPP_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Arena.hpp"
+#include "Governor.hpp"
+#include "ProgramCache.hpp"
+
+// Runs scripts for clients that connect to a Unix domain socket, so that
+// running a script costs neither a process start nor, once it has been
+// loaded, reading and tokenizing it. A request names the script file and
+// carries all the text its INPUT statements read; the reply carries what
+// the run printed, its errors and whether it ran to its end. Connections
+// are served by a pool of threads, one request each.
+//
+// Not available on Windows, where run() and request() fail.
+class Server
+{
+public:
+
+    // totalThreads of zero uses one thread per hardware thread.
+    explicit Server(
+        unsigned    totalThreads = 0,
+        std::size_t cacheCapacity = ProgramCache::DEFAULT_CAPACITY);
+
+    // Every run starts RND from the seed.
+    void setSeed(std::uint64_t seed) { m_seed = seed; m_isSeeded = true; }
+
+    // Applied to each run on its own.
+    void setLimits(const Governor::Limits& limits) { m_limits = limits; }
+
+    unsigned getTotalThreads() const { return m_totalThreads; }
+
+    const ProgramCache& getCache() const { return m_cache; }
+
+    // Listens on the socket, replacing a stale one, until stop() is called
+    // and then removes it. False, with the reason written to err, when the
+    // socket cannot be set up.
+    bool run(const std::string& socketPath, std::ostream& err);
+
+    // Makes run() return once the requests under way are answered. Safe to
+    // call from any thread and from a signal handler.
+    void stop();
+
+    // Has the server at socketPath run the script with the given input;
+    // a relative file name is taken from the current directory. Writes
+    // the output to out and the errors to err, and returns whether the
+    // script ran to its end.
+    static bool request(
+        const std::string& socketPath,
+        const std::string& fileName,
+        const std::string& input,
+        std::ostream&      out,
+        std::ostream&      err);
+
+private:
+
+    Server(const Server&);
+    Server& operator =(const Server&);
+
+    void work();
+    void serve(int connection, Arena& arena);
+
+    unsigned      m_totalThreads;
+    bool          m_isSeeded;
+    std::uint64_t m_seed;
+    ProgramCache  m_cache;
+
+    Governor::Limits m_limits;
+
+    std::atomic<bool> m_isStopping;
+    std::atomic<int>  m_listener;
+
+    std::mutex               m_mutex;
+    std::condition_variable  m_ready;
+    std::deque<int>          m_connections;
+    std::vector<std::thread> m_threads;
+};
+
+#endif // SERVER_HPP_INCLUDED
@@ -0,0 +1,100 @@
+#include <new>
+#include "SharedString.hpp"
+
+thread_local std::pmr::memory_resource* SharedString::s_resource = nullptr;
+
+
+SharedString::SharedString(const std::string& text)
+    : m_buffer(nullptr), m_data(""), m_size(0)
+{
+    if (!text.empty())
+    {
+        m_buffer = allocate(text.size());
+        std::memcpy(m_buffer->data, text.data(), text.size());
+        m_buffer->used = text.size();
+        m_data = m_buffer->data;
+        m_size = text.size();
+    }
+}
+
+
+void SharedString::append(const char* data, std::size_t size)
+{
+    if (0 == size)
+        return;
+
+    if (nullptr != m_buffer)
+    {
+        std::size_t end =
+            static_cast<std::size_t>(m_data - m_buffer->data) + m_size;
+
+        // The only owner may drop whatever other values left past its end.
+        if (1 == m_buffer->references)
+            m_buffer->used = end;
+
+        // Bytes past 'used' are invisible to every other owner of the
+        // buffer, so they can be written without breaking immutability.
+        if ((end == m_buffer->used) && (m_buffer->capacity - end >= size))
+        {
+            std::memcpy(m_buffer->data + end, data, size);
+            m_buffer->used += size;
+            m_size += size;
+            return;
+        }
+    }
+
+    Buffer* buffer = allocate(std::max<std::size_t>(2 * (m_size + size), 16));
+
+    std::memcpy(buffer->data, m_data, m_size);
+    std::memcpy(buffer->data + m_size, data, size);
+    buffer->used = m_size + size;
+
+    release();
+
+    m_buffer = buffer;
+    m_data = buffer->data;
+    m_size = buffer->used;
+}
+
+
+void SharedString::detach()
+{
+    if ((nullptr != m_buffer) || (0 == m_size))
+        return;
+
+    m_buffer = allocate(m_size);
+    std::memcpy(m_buffer->data, m_data, m_size);
+    m_buffer->used = m_size;
+    m_data = m_buffer->data;
+}
+
+
+SharedString::Buffer* SharedString::allocate(std::size_t capacity)
+{
+    std::size_t bytes = offsetof(Buffer, data) + capacity;
+
+    Buffer* buffer = static_cast<Buffer*>((nullptr != s_resource)
+        ? s_resource->allocate(bytes, alignof(Buffer))
+        : ::operator new(bytes));
+
+    buffer->references = 1;
+    buffer->capacity = capacity;
+    buffer->used = 0;
+    buffer->resource = s_resource;
+
+    return buffer;
+}
+
+
+void SharedString::free(Buffer* buffer)
+{
+    if (nullptr != buffer->resource)
+    {
+        buffer->resource->deallocate(
+            buffer, offsetof(Buffer, data) + buffer->capacity, alignof(Buffer));
+    }
+    else
+    {
+        ::operator delete(buffer);
+    }
+}
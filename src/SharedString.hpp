@@ -0,0 +1,254 @@
+#ifndef SHARED_STRING_HPP_INCLUDED
+#define SHARED_STRING_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include "StringKernels.hpp"
+
+// Immutable string value of the interpreter.
+//
+// A value either refers to bytes owned by somebody else (string literals,
+// which live in the loaded source text) or shares a reference-counted heap
+// buffer. Copying is a pointer bump. Appending writes in place whenever
+// nobody else can observe the bytes past the end of this value, so the
+// usual A$ = A$ + "..." loop grows a single buffer.
+//
+// Reference counts are not atomic: a value must not be shared between
+// threads.
+class SharedString
+{
+public:
+
+    // While one exists, buffers made on this thread come from the resource
+    // instead of the heap; each buffer goes back to where it came from.
+    // Scopes nest.
+    class ResourceScope
+    {
+    public:
+
+        explicit ResourceScope(std::pmr::memory_resource* resource)
+            : m_previous(s_resource)
+        {
+            s_resource = resource;
+        }
+
+        ~ResourceScope()
+        {
+            s_resource = m_previous;
+        }
+
+    private:
+
+        ResourceScope(const ResourceScope&);
+        ResourceScope& operator =(const ResourceScope&);
+
+        std::pmr::memory_resource* m_previous;
+    };
+
+    SharedString() : m_buffer(nullptr), m_data(""), m_size(0)
+    {
+    }
+
+    explicit SharedString(const std::string& text);
+
+    SharedString(const SharedString& other)
+        : m_buffer(other.m_buffer), m_data(other.m_data), m_size(other.m_size)
+    {
+        if (nullptr != m_buffer)
+            m_buffer->references++;
+    }
+
+    SharedString(SharedString&& other)
+        : m_buffer(other.m_buffer), m_data(other.m_data), m_size(other.m_size)
+    {
+        other.m_buffer = nullptr;
+        other.m_data = "";
+        other.m_size = 0;
+    }
+
+    ~SharedString()
+    {
+        release();
+    }
+
+    SharedString& operator=(const SharedString& other)
+    {
+        if (nullptr != other.m_buffer)
+            other.m_buffer->references++;
+
+        release();
+
+        m_buffer = other.m_buffer;
+        m_data = other.m_data;
+        m_size = other.m_size;
+        return *this;
+    }
+
+    SharedString& operator=(SharedString&& other)
+    {
+        if (this != &other)
+        {
+            release();
+
+            m_buffer = other.m_buffer;
+            m_data = other.m_data;
+            m_size = other.m_size;
+
+            other.m_buffer = nullptr;
+            other.m_data = "";
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    // Refers to [begin, end) without copying; the bytes must outlive
+    // every copy of the returned value.
+    static SharedString view(const char* begin, const char* end)
+    {
+        SharedString result;
+        result.m_data = begin;
+        result.m_size = static_cast<std::size_t>(end - begin);
+        return result;
+    }
+
+    // Fresh, unshared string of the given size; its bytes are to be
+    // written through 'data' before the value is used.
+    static SharedString uninitialized(std::size_t size, char*& data)
+    {
+        SharedString result;
+
+        if (0 != size)
+        {
+            result.m_buffer = allocate(size);
+            result.m_buffer->used = size;
+            result.m_data = result.m_buffer->data;
+            result.m_size = size;
+        }
+
+        data = result.m_buffer ? result.m_buffer->data : nullptr;
+        return result;
+    }
+
+    // Shares the bytes of this value; nothing is copied.
+    SharedString substr(std::size_t position, std::size_t count) const
+    {
+        SharedString result(*this);
+
+        position = std::min(position, m_size);
+        result.m_data += position;
+        result.m_size = std::min(count, m_size - position);
+        return result;
+    }
+
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return 0 == m_size;
+    }
+
+    std::string str() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+    int compare(const SharedString& other) const
+    {
+        if (m_data == other.m_data)
+            return (m_size < other.m_size) ? -1 : (m_size > other.m_size);
+
+        int result = StringKernels::compare(
+            m_data, other.m_data, std::min(m_size, other.m_size));
+
+        if (0 != result)
+            return result;
+
+        return (m_size < other.m_size) ? -1 : (m_size > other.m_size);
+    }
+
+    void append(const SharedString& other)
+    {
+        append(other.m_data, other.m_size);
+    }
+
+    void append(const char* data, std::size_t size);
+
+    // Copies bytes owned by somebody else into a buffer of this value's
+    // own, for when they are about to go away.
+    void detach();
+
+private:
+
+    struct Buffer
+    {
+        std::size_t                references;
+        std::size_t                capacity;
+        std::size_t                used;
+        std::pmr::memory_resource* resource;  // nullptr for the heap
+        char                       data[1];
+    };
+
+    static thread_local std::pmr::memory_resource* s_resource;
+
+    Buffer*     m_buffer;
+    const char* m_data;
+    std::size_t m_size;
+
+    static Buffer* allocate(std::size_t capacity);
+    static void free(Buffer* buffer);
+
+    void release()
+    {
+        if ((nullptr != m_buffer) && (0 == --m_buffer->references))
+            free(m_buffer);
+    }
+};
+
+inline bool operator==(const SharedString& a, const SharedString& b)
+{
+    return (a.size() == b.size()) && (0 == a.compare(b));
+}
+
+inline bool operator!=(const SharedString& a, const SharedString& b)
+{
+    return !(a == b);
+}
+
+inline bool operator<(const SharedString& a, const SharedString& b)
+{
+    return 0 > a.compare(b);
+}
+
+inline bool operator>(const SharedString& a, const SharedString& b)
+{
+    return 0 < a.compare(b);
+}
+
+inline bool operator<=(const SharedString& a, const SharedString& b)
+{
+    return 0 >= a.compare(b);
+}
+
+inline bool operator>=(const SharedString& a, const SharedString& b)
+{
+    return 0 <= a.compare(b);
+}
+
+inline std::ostream& operator<<(std::ostream& stream, const SharedString& s)
+{
+    return stream.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+#endif // SHARED_STRING_HPP_INCLUDED
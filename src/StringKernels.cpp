@@ -0,0 +1,173 @@
+#include <cstring>
+#include "StringKernels.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define STRING_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    inline unsigned lowestBit(unsigned mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    // Flips the case of every byte in [first, first + 26).
+    void convertCase(
+        char*       destination,
+        const char* source,
+        std::size_t size,
+        char        first)
+    {
+        std::size_t i = 0;
+
+#if defined(STRING_KERNELS_SSE2)
+        // Moving 'first' to -128 turns the range check into one signed
+        // comparison per byte.
+        const __m128i shift = _mm_set1_epi8(static_cast<char>(128 - first));
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+        const __m128i flip  = _mm_set1_epi8(0x20);
+
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(source + i));
+
+            __m128i isLetter = _mm_cmplt_epi8(_mm_add_epi8(v, shift), limit);
+
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(destination + i),
+                _mm_xor_si128(v, _mm_and_si128(isLetter, flip)));
+        }
+#endif
+
+        for (; i < size; i++)
+        {
+            unsigned char c = static_cast<unsigned char>(source[i]);
+            unsigned char offset = static_cast<unsigned char>(c - first);
+            destination[i] = static_cast<char>(offset < 26 ? c ^ 0x20 : c);
+        }
+    }
+}
+
+
+int StringKernels::compare(const char* a, const char* b, std::size_t size)
+{
+    std::size_t i = 0;
+
+#if defined(STRING_KERNELS_SSE2)
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFF;
+
+        if (0 != mask)
+        {
+            i += lowestBit(mask);
+            return static_cast<int>(static_cast<unsigned char>(a[i])) -
+                   static_cast<int>(static_cast<unsigned char>(b[i]));
+        }
+    }
+#endif
+
+    for (; i < size; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return static_cast<int>(static_cast<unsigned char>(a[i])) -
+                   static_cast<int>(static_cast<unsigned char>(b[i]));
+        }
+    }
+
+    return 0;
+}
+
+
+std::size_t StringKernels::find(
+    const char* haystack,
+    std::size_t sizeHaystack,
+    const char* needle,
+    std::size_t sizeNeedle)
+{
+    if (0 == sizeNeedle)
+        return 0;
+
+    if (sizeNeedle > sizeHaystack)
+        return NOT_FOUND;
+
+    const std::size_t last = sizeHaystack - sizeNeedle;
+
+    std::size_t i = 0;
+
+#if defined(STRING_KERNELS_SSE2)
+    // Candidates must match both the first and the last byte of the needle;
+    // only those are verified with a full comparison.
+    const __m128i firstByte = _mm_set1_epi8(needle[0]);
+    const __m128i lastByte  = _mm_set1_epi8(needle[sizeNeedle - 1]);
+
+    for (; i + 15 <= last; i += 16)
+    {
+        __m128i blockFirst = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(haystack + i));
+        __m128i blockLast = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(haystack + i + sizeNeedle - 1));
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(
+                _mm_cmpeq_epi8(blockFirst, firstByte),
+                _mm_cmpeq_epi8(blockLast, lastByte))));
+
+        while (0 != mask)
+        {
+            std::size_t candidate = i + lowestBit(mask);
+
+            if (0 == compare(haystack + candidate, needle, sizeNeedle))
+                return candidate;
+
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i <= last; i++)
+    {
+        if ((haystack[i] == needle[0]) &&
+            (0 == compare(haystack + i, needle, sizeNeedle)))
+            return i;
+    }
+
+    return NOT_FOUND;
+}
+
+
+void StringKernels::toUpper(
+    char*       destination,
+    const char* source,
+    std::size_t size)
+{
+    convertCase(destination, source, size, 'a');
+}
+
+
+void StringKernels::toLower(
+    char*       destination,
+    const char* source,
+    std::size_t size)
+{
+    convertCase(destination, source, size, 'A');
+}
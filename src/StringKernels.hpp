@@ -0,0 +1,29 @@
+#ifndef STRING_KERNELS_HPP_INCLUDED
+#define STRING_KERNELS_HPP_INCLUDED
+
+#include <cstddef>
+
+// Byte string primitives behind the BASIC string functions. They process
+// 16 bytes at a time with SSE2 where the target has it and fall back to
+// plain loops elsewhere. Case conversion only touches ASCII letters.
+class StringKernels
+{
+public:
+
+    static const std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+    // Same contract as memcmp: bytes compare as unsigned char.
+    static int compare(const char* a, const char* b, std::size_t size);
+
+    // Position of the first occurrence of the needle, or NOT_FOUND.
+    static std::size_t find(
+        const char* haystack,
+        std::size_t sizeHaystack,
+        const char* needle,
+        std::size_t sizeNeedle);
+
+    static void toUpper(char* destination, const char* source, std::size_t size);
+    static void toLower(char* destination, const char* source, std::size_t size);
+};
+
+#endif // STRING_KERNELS_HPP_INCLUDED
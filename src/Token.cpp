@@ -1,5 +1,58 @@
 #include "Token.hpp"
 
+// Portable _memicmp: compares the bytes as lower case.
+static int compareNoCase(const char* a, const char* b, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; i++)
+    {
+        int x = std::tolower(static_cast<unsigned char>(a[i]));
+        int y = std::tolower(static_cast<unsigned char>(b[i]));
+
+        if (x != y)
+            return x - y;
+    }
+
+    return 0;
+}
+
+// Indexed by keyword, in the order of Token::Value.
+static const char* const KEYWORD_NAMES[] =
+{
+    "CHECKPOINT",
+    "DIM",
+    "ELSE",
+    "END",
+    "FOR",
+    "GOSUB",
+    "GOTO",
+    "IF",
+    "INPUT",
+    "LET",
+    "MAT",
+    "NEXT",
+    "PRINT",
+    "RANDOMIZE",
+    "RECEIVE",
+    "REM",
+    "RETURN",
+    "SEND",
+    "STEP",
+    "STOP",
+    "THEN",
+    "TO"
+};
+
+static_assert(
+    sizeof(KEYWORD_NAMES) / sizeof(KEYWORD_NAMES[0]) == Token::KEYWORD_TO - Token::TYPE_KEYWORD,
+    "Every keyword needs a name");
+
+const char* Token::getKeywordName(Value keyword)
+{
+    assert((TYPE_KEYWORD < keyword) && (keyword <= KEYWORD_TO));
+    return KEYWORD_NAMES[keyword - TYPE_KEYWORD - 1];
+}
+
+
 const char* Token::parse(const char* begin, const char* end)
 {
     struct Entry
@@ -13,9 +66,13 @@ const char* Token::parse(const char* begin, const char* end)
         { "ABS"    , FUNCTION_ABS    },
         { "AND"    , OPERATOR_AND    },
         { "ATN"    , FUNCTION_ATN    },
+        { "CHECKPOINT", KEYWORD_CHECKPOINT },
         { "COS"    , FUNCTION_COS    },
+        { "DIM"    , KEYWORD_DIM     },
         { "ELSE"   , KEYWORD_ELSE    },
         { "END"    , KEYWORD_END     },
+        { "EXEC"   , FUNCTION_EXEC   },
+        { "EXEC$"  , FUNCTION_EXEC_OUTPUT },
         { "EXP"    , FUNCTION_EXP    },
         { "FIX"    , FUNCTION_FIX    },
         { "FOR"    , KEYWORD_FOR     },
@@ -23,27 +80,42 @@ const char* Token::parse(const char* begin, const char* end)
         { "GOTO"   , KEYWORD_GOTO    },
         { "IF"     , KEYWORD_IF      },
         { "INPUT"  , KEYWORD_INPUT   },
+        { "INSTR"  , FUNCTION_INSTR  },
         { "INT"    , FUNCTION_INT    },
+        { "LCASE$" , FUNCTION_LCASE  },
+        { "LEFT$"  , FUNCTION_LEFT   },
+        { "LEN"    , FUNCTION_LEN    },
         { "LET"    , KEYWORD_LET     },
         { "LOG"    , FUNCTION_LOG    },
+        { "MAT"    , KEYWORD_MAT     },
+        { "MID$"   , FUNCTION_MID    },
         { "MOD"    , OPERATOR_MODULO },
         { "NEXT"   , KEYWORD_NEXT    },
         { "NOT"    , OPERATOR_NOT    },
         { "OR"     , OPERATOR_OR     },
         { "PRINT"  , KEYWORD_PRINT   },
+        { "RANDOMIZE", KEYWORD_RANDOMIZE },
+        { "RECEIVE", KEYWORD_RECEIVE },
         { "REM"    , KEYWORD_REM     },
         { "RETURN" , KEYWORD_RETURN  },
+        { "RIGHT$" , FUNCTION_RIGHT  },
         { "RND"    , FUNCTION_RND    },
+        { "SEND"   , KEYWORD_SEND    },
         { "SGN"    , FUNCTION_SGN    },
         { "SHELL"  , FUNCTION_SHELL  },
+        { "SHELL$" , FUNCTION_SHELL_OUTPUT },
         { "SIN"    , FUNCTION_SIN    },
+        { "SPAWN"  , FUNCTION_SPAWN  },
         { "SQR"    , FUNCTION_SQR    },
         { "STEP"   , KEYWORD_STEP    },
         { "STOP"   , KEYWORD_STOP    },
         { "TAN"    , FUNCTION_TAN    },
         { "THEN"   , KEYWORD_THEN    },
         { "TO"     , KEYWORD_TO      },
-        { "VAL"    , FUNCTION_VAL    }
+        { "UCASE$" , FUNCTION_UCASE  },
+        { "VAL"    , FUNCTION_VAL    },
+        { "WAIT"   , FUNCTION_WAIT   },
+        { "WAIT$"  , FUNCTION_WAIT_OUTPUT }
     };
 
     enum State
@@ -211,35 +283,54 @@ const char* Token::parse(const char* begin, const char* end)
             {
                 m_string.end = current;
 
-                const size_t COUNT_TABLE = sizeof(table) / sizeof(table[0]);
-
-                bool entryFound = false;
-
-                auto entry = std::lower_bound(
-                    &table[0],
-                    &table[COUNT_TABLE],
-                    m_string,
-                    [&entryFound](const Entry& entry, const String& id) -> bool
+                auto lookup = [](const String& id) -> const Entry*
                     {
-                        size_t sizeEntry =
-                            static_cast<size_t>(std::strlen(entry.id));
-                        size_t sizeId = static_cast<size_t>(id.end - id.begin);
-                        size_t size = std::min(sizeEntry, sizeId);
-
-                        auto result = ::_memicmp(entry.id, id.begin, size);
-
-                        if (0 == result)
-                        {
-                            if (sizeEntry == sizeId)
-                                entryFound = true;
-                            else if (sizeEntry < sizeId)
-                                return true;
-                        }
+                        const size_t COUNT_TABLE =
+                            sizeof(table) / sizeof(table[0]);
+
+                        bool entryFound = false;
+
+                        auto entry = std::lower_bound(
+                            &table[0],
+                            &table[COUNT_TABLE],
+                            id,
+                            [&entryFound](const Entry& entry, const String& id) -> bool
+                            {
+                                size_t sizeEntry =
+                                    static_cast<size_t>(std::strlen(entry.id));
+                                size_t sizeId =
+                                    static_cast<size_t>(id.end - id.begin);
+                                size_t size = std::min(sizeEntry, sizeId);
+
+                                auto result = compareNoCase(entry.id, id.begin, size);
+
+                                if (0 == result)
+                                {
+                                    if (sizeEntry == sizeId)
+                                        entryFound = true;
+                                    else if (sizeEntry < sizeId)
+                                        return true;
+                                }
+
+                                return 0 > result;
+                            });
+
+                        return entryFound ? entry : nullptr;
+                    };
+
+                // String functions carry the '$' suffix in their names.
+                if ('$' == currentChar)
+                {
+                    String id = { m_string.begin, next };
 
-                        return 0 > result;
-                    });
+                    if (const Entry* entry = lookup(id))
+                    {
+                        m_value = entry->value;
+                        return next;
+                    }
+                }
 
-                if (entryFound)
+                if (const Entry* entry = lookup(m_string))
                 {
                     m_value = entry->value;
                     return current;
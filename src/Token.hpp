@@ -4,8 +4,10 @@
 #include <cassert>
 #include <cctype>
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 #include <string>
+#include "SharedString.hpp"
 
 class Token
 {
@@ -21,17 +23,30 @@ public:
         FUNCTION_ABS,
         FUNCTION_ATN,
         FUNCTION_COS,
+        FUNCTION_EXEC,
+        FUNCTION_EXEC_OUTPUT,
         FUNCTION_EXP,
         FUNCTION_FIX,
+        FUNCTION_INSTR,
         FUNCTION_INT,
+        FUNCTION_LCASE,
+        FUNCTION_LEFT,
+        FUNCTION_LEN,
         FUNCTION_LOG,
+        FUNCTION_MID,
+        FUNCTION_RIGHT,
         FUNCTION_RND,
         FUNCTION_SGN,
         FUNCTION_SHELL,
+        FUNCTION_SHELL_OUTPUT,
         FUNCTION_SIN,
+        FUNCTION_SPAWN,
         FUNCTION_SQR,
         FUNCTION_TAN,
+        FUNCTION_UCASE,
         FUNCTION_VAL,
+        FUNCTION_WAIT,
+        FUNCTION_WAIT_OUTPUT,
 
         TYPE_IDENTIFIER = 0x2000,
         IDENTIFIER_REAL,
@@ -40,6 +55,8 @@ public:
         IDENTIFIER_STRING,
 
         TYPE_KEYWORD = 0x3000,
+        KEYWORD_CHECKPOINT,
+        KEYWORD_DIM,
         KEYWORD_ELSE,
         KEYWORD_END,
         KEYWORD_FOR,
@@ -48,10 +65,14 @@ public:
         KEYWORD_IF,
         KEYWORD_INPUT,
         KEYWORD_LET,
+        KEYWORD_MAT,
         KEYWORD_NEXT,
         KEYWORD_PRINT,
+        KEYWORD_RANDOMIZE,
+        KEYWORD_RECEIVE,
         KEYWORD_REM,
         KEYWORD_RETURN,
+        KEYWORD_SEND,
         KEYWORD_STEP,
         KEYWORD_STOP,
         KEYWORD_THEN,
@@ -90,7 +111,7 @@ public:
 
     Token()
     {
-        ::memset(this, 0, sizeof(Token));
+        ::memset(static_cast<void*>(this), 0, sizeof(Token));
     }
 
     Value getType() const
@@ -121,16 +142,38 @@ public:
         return std::string(m_string.begin, m_string.end);
     }
 
+    SharedString getLiteralString() const
+    {
+        assert(LITERAL_STRING == m_value);
+        return SharedString::view(m_string.begin, m_string.end);
+    }
+
     std::string getIdentifier() const
     {
         assert(TYPE_IDENTIFIER == (TYPE_MASK & m_value));
         std::string id(getString());
-        std::transform(id.begin(), id.end(), id.begin(), std::toupper);
+        std::transform(id.begin(), id.end(), id.begin(),
+            [](char c) -> char
+            {
+                return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            });
         return id;
     }
 
+    // Number the program gave the identifier's name; see Program::getName().
+    std::size_t getSlot() const
+    {
+        assert(TYPE_IDENTIFIER == (TYPE_MASK & m_value));
+        return m_slot;
+    }
+
+    void setSlot(std::size_t slot) { m_slot = static_cast<std::uint32_t>(slot); }
+
     const char* parse(const char* begin, const char* end);
 
+    // Name of a keyword as programs spell it.
+    static const char* getKeywordName(Value keyword);
+
 private:
 
     struct String
@@ -146,7 +189,8 @@ private:
         String       m_string;
     };
 
-    Value m_value;
+    Value         m_value;
+    std::uint32_t m_slot;
 };
 
 #endif // TOKEN_HPP_INCLUDED
@@ -0,0 +1,182 @@
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include "Checkpoint.hpp"
+#include "Program.hpp"
+#include "Trace.hpp"
+
+// A header of integers as in checkpoints, then ten bytes an entry: the
+// line and the next line in four little-endian bytes each and the token
+// in two.
+static const char TRACE_MAGIC[8] = { 'C', 'I', 'T', 'T', 'R', 'A', 'C', 'E' };
+static const std::uint64_t TRACE_VERSION = 1;
+static const std::size_t EVENT_BYTES = 10;
+
+static void putBytes(char* bytes, std::uint32_t value, int total)
+{
+    for (int i = 0; i < total; i++)
+        bytes[i] = static_cast<char>(value >> (8 * i));
+}
+
+
+static std::uint32_t getBytes(const unsigned char* bytes, int total)
+{
+    std::uint32_t value = 0;
+
+    for (int i = 0; i < total; i++)
+        value |= static_cast<std::uint32_t>(bytes[i]) << (8 * i);
+
+    return value;
+}
+
+
+bool Trace::write(const std::string& fileName, const Program& program, std::ostream& err) const
+{
+    std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    std::uint64_t count = (m_total < CAPACITY) ? m_total : CAPACITY;
+
+    CheckpointWriter writer(file);
+
+    file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    writer.putInteger(TRACE_VERSION);
+    writer.putInteger(program.getHash());
+    writer.putInteger(m_total);
+    writer.putInteger(count);
+
+    for (std::uint64_t i = m_total - count; i < m_total; i++)
+    {
+        const Event& event = m_events[i & (CAPACITY - 1)];
+
+        char bytes[EVENT_BYTES];
+        putBytes(bytes, event.line, 4);
+        putBytes(bytes + 4, event.next, 4);
+        putBytes(bytes + 8, event.kind, 2);
+
+        file.write(bytes, sizeof(bytes));
+    }
+
+    file.close();
+
+    if (file.fail())
+    {
+        err << "Cannot write trace \"" << fileName << "\"!\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+static std::string getLineName(std::uint32_t line, const Program* program)
+{
+    if (Trace::FAILED == line)
+        return "failed";
+
+    if (nullptr == program)
+        return std::to_string(line + 1);
+
+    if (line >= program->getTotalLines())
+        return "end";
+
+    return std::to_string(program->getLineNumber(line));
+}
+
+
+static const char* getKindName(std::uint16_t kind)
+{
+    Token::Value value = static_cast<Token::Value>(kind);
+
+    if ((Token::TYPE_KEYWORD < value) && (value <= Token::KEYWORD_TO))
+        return Token::getKeywordName(value);
+
+    if (Token::TYPE_IDENTIFIER == (Token::TYPE_MASK & value))
+        return "(assignment)";
+
+    // Labels and comments alone on their line.
+    if (Token::INVALID == value)
+        return "-";
+
+    return "(other)";
+}
+
+
+bool Trace::decode(
+    std::istream&  file,
+    const Program* program,
+    std::ostream&  out,
+    std::ostream&  err)
+{
+    char magic[sizeof(TRACE_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+
+    CheckpointReader reader(file);
+
+    std::uint64_t version = reader.getInteger();
+    std::uint64_t hash = reader.getInteger();
+    std::uint64_t total = reader.getInteger();
+    std::uint64_t count = reader.getInteger();
+
+    if (!reader.isGood() ||
+        (0 != std::memcmp(magic, TRACE_MAGIC, sizeof(magic))) ||
+        (TRACE_VERSION != version) ||
+        (count > total))
+    {
+        err << "Bad trace!\n";
+        return false;
+    }
+
+    if ((nullptr != program) && (program->getHash() != hash))
+    {
+        err << "Trace is of another program!\n";
+        program = nullptr;
+    }
+
+    out << "Trace: " << total << " lines run, the last " << count << " follow";
+
+    if (nullptr == program)
+        out << " (lines counted in load order)";
+
+    out << "\n\n" << std::setw(6) << "Line" << " "
+        << std::setw(12) << "Statement" << " "
+        << std::setw(6) << "Next";
+
+    if (nullptr != program)
+        out << "  Source";
+
+    out << "\n";
+
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        unsigned char bytes[EVENT_BYTES];
+        file.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+
+        if (file.fail())
+        {
+            err << "Bad trace!\n";
+            return false;
+        }
+
+        std::uint32_t line = getBytes(bytes, 4);
+        std::uint32_t next = getBytes(bytes + 4, 4);
+        std::uint16_t kind = static_cast<std::uint16_t>(getBytes(bytes + 8, 2));
+
+        if ((nullptr != program) && (line >= program->getTotalLines()))
+        {
+            err << "Bad trace!\n";
+            return false;
+        }
+
+        out << std::setw(6) << getLineName(line, program) << " "
+            << std::setw(12) << getKindName(kind) << " "
+            << std::setw(6) << getLineName(next, program);
+
+        if (nullptr != program)
+            out << "  " << program->getSourceLine(line);
+
+        out << "\n";
+    }
+
+    return true;
+}
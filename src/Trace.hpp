@@ -0,0 +1,71 @@
+#ifndef TRACE_HPP_INCLUDED
+#define TRACE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "Token.hpp"
+
+class Program;
+
+// The last lines a run went through, kept all the time: each line run
+// overwrites the oldest entry of a fixed ring with the line, the token its
+// statement starts with and the line that ran next, a few stores and no
+// allocation. write() saves the ring, typically after a failure, and
+// decode() turns the file back into text.
+class Trace
+{
+public:
+
+    // A power of two.
+    static const std::size_t CAPACITY = 256;
+
+    // Next line of a line that failed.
+    static const std::uint32_t FAILED = 0xFFFFFFFF;
+
+    Trace() : m_total(0) {}
+
+    void clear() { m_total = 0; }
+
+    // A next line of SIZE_MAX is stored as FAILED.
+    void record(std::size_t line, Token::Value kind, std::size_t next)
+    {
+        Event& event = m_events[m_total++ & (CAPACITY - 1)];
+        event.line = static_cast<std::uint32_t>(line);
+        event.next = static_cast<std::uint32_t>(next);
+        event.kind = static_cast<std::uint16_t>(kind);
+    }
+
+    // Lines recorded since clear(), of which the last CAPACITY are kept.
+    std::uint64_t getTotal() const { return m_total; }
+
+    // Oldest entry first; the program's hash goes along so that decode()
+    // can tell whether it has the same program. Errors are reported to
+    // err.
+    bool write(const std::string& fileName, const Program& program, std::ostream& err) const;
+
+    // Prints the entries of a trace file, with the source of every line
+    // when program is the program traced; pass nullptr when there is
+    // none. Lines are then counted from 1 in the order they were loaded.
+    static bool decode(
+        std::istream&  file,
+        const Program* program,
+        std::ostream&  out,
+        std::ostream&  err);
+
+private:
+
+    struct Event
+    {
+        std::uint32_t line;
+        std::uint32_t next;
+        std::uint16_t kind;
+    };
+
+    Event         m_events[CAPACITY];
+    std::uint64_t m_total;
+};
+
+#endif // TRACE_HPP_INCLUDED
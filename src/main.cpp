@@ -1,13 +1,454 @@
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <fstream>
 #include <iostream>
-#include <windows.h>
+#include <mutex>
+#include <vector>
 #include "Interpreter.hpp"
+#include "MappedFile.hpp"
+#include "RecordRunner.hpp"
+#include "Server.hpp"
+#include "Trace.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
 #include "resource.h"
+#endif
+
+// Writes a profiler report to the named file, or to the console when no
+// file name was given.
+template <typename Report>
+static void writeReport(
+    const Report&      report,
+    const std::string& fileName,
+    const Program&     program)
+{
+    if (fileName.empty())
+    {
+        report.report(std::cerr, program);
+        return;
+    }
+
+    std::ofstream file(fileName.c_str(), std::ios::out);
+
+    if (file.is_open())
+        report.report(file, program);
+    else
+        std::cerr << "Cannot open \"" << fileName << "\"!\n";
+}
+
+
+// Runs the program in slices and reloads the file whenever it changes in
+// between. The run goes on with its variables where it can, and starts
+// over where it cannot; INPUT reads a whole line per statement, as in any
+// resumable run.
+static bool runWatched(
+    Program&                program,
+    const std::string&      fileName,
+    const Governor::Limits& limits,
+    bool                    isSeeded,
+    std::uint64_t           seed,
+    const std::string&      traceFileName)
+{
+    static const double WATCH_INTERVAL = 0.1;
+
+    // Woken by the channel the run waits for, once it may go on.
+    struct Waiter : Channel::Waiter
+    {
+        Waiter() : isWoken(false) {}
+
+        void wake()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isWoken = true;
+            condition.notify_one();
+        }
+
+        std::mutex              mutex;
+        std::condition_variable condition;
+        bool                    isWoken;
+    };
+
+    Waiter waiter;
+
+    Execution execution(program);
+    execution.setLimits(limits);
+    execution.setTraceFile(traceFileName);
+    execution.setTimeSlice(WATCH_INTERVAL);
+
+    if (isSeeded)
+        execution.setSeed(seed);
+
+    ProgramCache::Stamp stamp;
+    ProgramCache::getStamp(fileName, stamp);
+
+    execution.start();
+
+    while (true)
+    {
+        switch (execution.resume())
+        {
+        case Execution::STATUS_FINISHED:
+            return true;
+
+        case Execution::STATUS_FAILED:
+            return false;
+
+        case Execution::STATUS_WAITING_INPUT:
+            {
+                std::string line;
+
+                if (std::getline(std::cin, line))
+                    execution.provideInput(line + "\n");
+                else
+                    execution.closeInput();
+            }
+            break;
+
+        case Execution::STATUS_WAITING_SHELL:
+            execution.completeCall();
+            break;
+
+        // Parked on the channel, but for no longer than the watch interval,
+        // so that changes to the file are still picked up.
+        case Execution::STATUS_WAITING_CHANNEL:
+            {
+                Channel* channel = execution.getWaitChannel();
+                bool isWoken = true;
+
+                waiter.isWoken = false;
+
+                if (channel->park(&waiter, execution.isWaitingToSend()))
+                {
+                    std::unique_lock<std::mutex> lock(waiter.mutex);
+
+                    isWoken = waiter.condition.wait_for(lock,
+                        std::chrono::duration<double>(WATCH_INTERVAL),
+                        [&waiter]() { return waiter.isWoken; });
+                }
+
+                // The channel wakes its waiters under its own lock.
+                if (!isWoken)
+                    channel->cancel(&waiter);
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        ProgramCache::Stamp current;
+
+        if (!ProgramCache::getStamp(fileName, current) || (current == stamp))
+            continue;
+
+        stamp = current;
+
+        std::ifstream file(fileName.c_str(), std::ios::in);
+        Program::LineMap lineMap;
+
+        if (file.is_open() && program.reload(file, lineMap))
+        {
+            if (!execution.relocate(lineMap))
+            {
+                std::cerr << "Restarting \"" << fileName << "\"!\n";
+                execution.start();
+            }
+
+            // Either way the run refers to none of the replaced lines.
+            program.releaseRetired();
+        }
+    }
+}
+
+
+static Server* s_server = nullptr;
+static Interpreter* s_interpreter = nullptr;
+
+static void stopServer(int)
+{
+    if (nullptr != s_server)
+        s_server->stop();
+}
+
+
+static void requestCheckpoint(int)
+{
+    if (nullptr != s_interpreter)
+        s_interpreter->requestCheckpoint();
+}
+
+
+static void requestTrace(int)
+{
+    if (nullptr != s_interpreter)
+        s_interpreter->requestTrace();
+}
+
+
+// Prints a trace file, with the source lines when the program that wrote
+// it is given as well.
+static bool decodeTrace(const std::string& traceFileName, const std::string& fileName)
+{
+    std::ifstream trace(traceFileName.c_str(), std::ios::in | std::ios::binary);
+
+    if (!trace.is_open())
+    {
+        std::cerr << "Cannot open \"" << traceFileName << "\"!\n";
+        return false;
+    }
+
+    Program program;
+
+    if (!fileName.empty())
+    {
+        std::ifstream file(fileName.c_str(), std::ios::in);
+
+        if (!file.is_open())
+        {
+            std::cerr << "Cannot open \"" << fileName << "\"!\n";
+            return false;
+        }
+
+        if (!program.load(file))
+            return false;
+    }
+
+    return Trace::decode(trace, fileName.empty() ? nullptr : &program, std::cout, std::cerr);
+}
+
+
+// Reads the number that follows the first prefix characters of the
+// argument. Anything but a whole number from min to max is reported, and
+// leaves value as it was. (The parentheses keep max clear of the macro in
+// <windows.h>.)
+template <typename T>
+static bool parseInteger(
+    const std::string& argument,
+    std::size_t        prefix,
+    T&                 value,
+    std::uint64_t      min = 0,
+    std::uint64_t      max = (std::numeric_limits<T>::max)())
+{
+    const char* text = argument.c_str() + prefix;
+    char* end = nullptr;
+
+    errno = 0;
+    unsigned long long number = std::strtoull(text, &end, 10);
+
+    if (!std::isdigit(static_cast<unsigned char>(*text)) || ('\0' != *end) ||
+        (ERANGE == errno) || (number < min) || (number > max))
+    {
+        std::cerr << "Bad number in \"" << argument << "\"!\n";
+        return false;
+    }
+
+    value = static_cast<T>(number);
+    return true;
+}
+
+
+// Same for a number of seconds, which can be fractional; zero is only
+// taken when isZeroAllowed.
+static bool parseSeconds(
+    const std::string& argument,
+    std::size_t        prefix,
+    double&            value,
+    bool               isZeroAllowed = true)
+{
+    const char* text = argument.c_str() + prefix;
+    char* end = nullptr;
+
+    double number = std::strtod(text, &end);
+
+    if ((end == text) || ('\0' != *end) || !std::isfinite(number) || (number < 0) ||
+        (!isZeroAllowed && (0 == number)))
+    {
+        std::cerr << "Bad number of seconds in \"" << argument << "\"!\n";
+        return false;
+    }
+
+    value = number;
+    return true;
+}
+
 
 int main(int argc, char* argv[])
 {
+    // Options may go anywhere on the command line; the remaining arguments
+    // are the source file name and the code page, in that order.
+    std::vector<std::string> arguments;
+
+    bool profile = false;
+    std::string profileFileName;
+
+    unsigned sampleRate = 0;
+    std::string sampleFileName;
+
+    bool allocationProfile = false;
+    std::string allocationProfileFileName;
+
+    bool perfMap = false;
+    bool watch = false;
+
+    std::string recordsFileName;
+    unsigned totalThreads = 0;
+
+    bool isSeeded = false;
+    std::uint64_t seed = 0;
+    std::uint64_t stream = 0;
+
+    Governor::Limits limits;
+
+    std::string serveSocket;
+    std::string clientSocket;
+    std::size_t cacheCapacity = ProgramCache::DEFAULT_CAPACITY;
+
+    std::string checkpointFileName;
+    std::string resumeFileName;
+
+    std::string metricsFileName;
+    double metricsInterval = 10;
+
+    std::string traceFileName;
+    std::string decodeTraceFileName;
+
+    std::string recordFileName;
+    std::string replayFileName;
+
+    bool isValid = true;
+
+    for (int i = 1; (i < argc) && isValid; i++)
+    {
+        std::string argument(argv[i]);
+
+        if ("--profile" == argument)
+            profile = true;
+        else if (0 == argument.compare(0, 10, "--profile="))
+            profile = true, profileFileName = argument.substr(10);
+        else if ("--sample" == argument)
+            sampleRate = Sampler::DEFAULT_RATE;
+        else if (0 == argument.compare(0, 9, "--sample="))
+            isValid = parseInteger(argument, 9, sampleRate, 1, Sampler::MAX_RATE);
+        else if (0 == argument.compare(0, 14, "--sample-file="))
+            sampleFileName = argument.substr(14);
+        else if ("--alloc-profile" == argument)
+            allocationProfile = true;
+        else if (0 == argument.compare(0, 16, "--alloc-profile="))
+            allocationProfile = true, allocationProfileFileName = argument.substr(16);
+        else if ("--perf-map" == argument)
+            perfMap = true;
+        else if ("--watch" == argument)
+            watch = true;
+        else if (0 == argument.compare(0, 10, "--records="))
+            recordsFileName = argument.substr(10);
+        else if (0 == argument.compare(0, 10, "--threads="))
+            isValid = parseInteger(argument, 10, totalThreads);
+        else if (0 == argument.compare(0, 7, "--seed="))
+            isSeeded = parseInteger(argument, 7, seed), isValid = isSeeded;
+        else if (0 == argument.compare(0, 9, "--stream="))
+            isValid = parseInteger(argument, 9, stream);
+        else if (0 == argument.compare(0, 17, "--max-statements="))
+            isValid = parseInteger(argument, 17, limits.statements);
+        else if (0 == argument.compare(0, 11, "--max-time="))
+            isValid = parseSeconds(argument, 11, limits.wallSeconds);
+        else if (0 == argument.compare(0, 10, "--max-cpu="))
+            isValid = parseSeconds(argument, 10, limits.cpuSeconds);
+        else if (0 == argument.compare(0, 13, "--max-memory="))
+            isValid = parseInteger(argument, 13, limits.memoryBytes);
+        else if (0 == argument.compare(0, 8, "--serve="))
+            serveSocket = argument.substr(8);
+        else if (0 == argument.compare(0, 9, "--client="))
+            clientSocket = argument.substr(9);
+        else if (0 == argument.compare(0, 8, "--cache="))
+            isValid = parseInteger(argument, 8, cacheCapacity, 1);
+        else if (0 == argument.compare(0, 13, "--checkpoint="))
+            checkpointFileName = argument.substr(13);
+        else if (0 == argument.compare(0, 9, "--resume="))
+            resumeFileName = argument.substr(9);
+        else if (0 == argument.compare(0, 10, "--metrics="))
+            metricsFileName = argument.substr(10);
+        else if (0 == argument.compare(0, 19, "--metrics-interval="))
+            isValid = parseSeconds(argument, 19, metricsInterval, false);
+        else if (0 == argument.compare(0, 8, "--trace="))
+            traceFileName = argument.substr(8);
+        else if (0 == argument.compare(0, 15, "--decode-trace="))
+            decodeTraceFileName = argument.substr(15);
+        else if (0 == argument.compare(0, 9, "--record="))
+            recordFileName = argument.substr(9);
+        else if (0 == argument.compare(0, 9, "--replay="))
+            replayFileName = argument.substr(9);
+        else
+            arguments.push_back(argument);
+    }
+
+    if (!isValid)
+        return 1;
+
+    // A run is driven by one profiler at most.
+    const int totalProfilers = (profile ? 1 : 0) + ((0 != sampleRate) ? 1 : 0) +
+        (perfMap ? 1 : 0) + (allocationProfile ? 1 : 0);
+
+    if (totalProfilers > 1)
+    {
+        std::cerr << "Only one of --profile, --sample, --perf-map and --alloc-profile can be given!\n";
+        return 1;
+    }
+
+    if (!decodeTraceFileName.empty())
+        return decodeTrace(decodeTraceFileName, arguments.empty() ? "" : arguments[0]) ? 0 : 1;
+
+    // Serving runs until interrupted; the source files come with the
+    // requests.
+    if (!serveSocket.empty())
+    {
+        Server server(totalThreads, cacheCapacity);
+
+        if (isSeeded)
+            server.setSeed(seed);
+
+        server.setLimits(limits);
+
+        s_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+
+        bool isServed = server.run(serveSocket, std::cerr);
+
+        s_server = nullptr;
+        return isServed ? 0 : 1;
+    }
+
+    // The whole of standard input goes with the request.
+    if (!clientSocket.empty())
+    {
+        if (arguments.empty())
+        {
+            std::cerr << "No source file name!\n";
+            return 1;
+        }
+
+        std::string input(
+            (std::istreambuf_iterator<char>(std::cin)),
+            std::istreambuf_iterator<char>());
+
+        return Server::request(
+            clientSocket, arguments[0], input, std::cout, std::cerr) ? 0 : 1;
+    }
+
+    std::string title("CIT BASIC 1.0");
+
+#ifdef _WIN32
     HWND hwnd = ::GetConsoleWindow();
 
     HINSTANCE hinst = reinterpret_cast<HINSTANCE>(
@@ -17,65 +458,201 @@ int main(int argc, char* argv[])
 
     ::SetClassLongPtr(hwnd, GCLP_HICON, reinterpret_cast<LONG_PTR>(hicon));
 
-    std::string title("CIT BASIC 1.0");
     ::SetConsoleTitleA(title.c_str());
 
     UINT codePageId = 1251;
 
-    if (argc > 2)
+    if (arguments.size() > 1)
     {
-        std::string codePage(argv[2]);
+        std::string codePage(arguments[1]);
 
         std::transform(
             codePage.begin(),
             codePage.end(),
             codePage.begin(),
-            std::toupper);
+            [](char c) -> char
+            {
+                return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            });
 
         if (("DOS" == codePage) || ("OEM" == codePage))
             codePageId = CP_OEMCP;
-        else
-            codePageId = static_cast<UINT>(std::stoul(codePage));
+        else if (!parseInteger(codePage, 0, codePageId))
+            return 1;
     }
 
     ::SetConsoleCP(codePageId);
     ::SetConsoleOutputCP(codePageId);
+#endif
 
     bool fileNamePassedAsParameter = false;
 
     std::string fileName;
 
-    if (argc <= 1)
+    if (arguments.empty())
     {
         std::cout << "Input source file name: ";
         std::getline(std::cin, fileName);
     }
     else
     {
-        fileName = argv[1];
+        fileName = arguments[0];
         fileNamePassedAsParameter = true;
     }
 
     std::ifstream file(fileName.c_str(), std::ios::in);
 
-    if (file.is_open())
+    bool isDone = false;
+
+    if (watch && file.is_open())
+    {
+        Program program;
+
+        bool isLoaded = program.load(file);
+
+        file.close();
+
+        isDone = isLoaded && runWatched(program, fileName, limits, isSeeded, seed, traceFileName);
+    }
+    else if (file.is_open())
     {
         title.append(" \"").append(fileName).append("\"");
+#ifdef _WIN32
         ::SetConsoleTitleA(title.c_str());
+#endif
 
         Interpreter interpreter;
+        Profiler profiler;
+        Sampler sampler(sampleRate);
+        PerfMap lineStubs(fileName);
+        AllocationProfiler allocationProfiler;
+        Recording recording;
+
+        if (isSeeded)
+            interpreter.setSeed(seed);
+
+        interpreter.setStream(stream);
+        interpreter.setLimits(limits);
+        interpreter.setTraceFile(traceFileName);
+
+        // A resumed run checkpoints to where it came from unless told
+        // otherwise.
+        if (!checkpointFileName.empty())
+            interpreter.setCheckpointFile(checkpointFileName);
+        else if (!resumeFileName.empty())
+            interpreter.setCheckpointFile(resumeFileName);
+
+        if (profile)
+            interpreter.setProfiler(&profiler);
+        else if (0 != sampleRate)
+            interpreter.setSampler(&sampler);
+        else if (perfMap)
+            interpreter.setPerfMap(&lineStubs);
+        else if (allocationProfile)
+            interpreter.setAllocationProfiler(&allocationProfiler);
+
+        if (allocationProfile && !AllocationProfiler::isTracking())
+            std::cerr << "Allocations are only counted in a build with CITBASIC_ALLOC_TRACKING!\n";
+
         bool isLoaded = interpreter.load(file);
         
         file.close();
 
-        if (isLoaded)
-            interpreter.run();
+        if (isLoaded && !resumeFileName.empty())
+        {
+            std::ifstream checkpoint(resumeFileName.c_str(), std::ios::in | std::ios::binary);
+
+            if (checkpoint.is_open())
+            {
+                isLoaded = interpreter.restore(checkpoint);
+            }
+            else
+            {
+                std::cerr << "Cannot open \"" << resumeFileName << "\"!\n";
+                isLoaded = false;
+            }
+        }
+
+        if (isLoaded && !replayFileName.empty())
+        {
+            std::ifstream replay(replayFileName.c_str(), std::ios::in | std::ios::binary);
+
+            if (replay.is_open())
+            {
+                isLoaded = recording.read(replay, interpreter.getProgram(), std::cerr);
+                interpreter.setReplay(&recording);
+            }
+            else
+            {
+                std::cerr << "Cannot open \"" << replayFileName << "\"!\n";
+                isLoaded = false;
+            }
+        }
+        else if (!recordFileName.empty())
+        {
+            interpreter.setRecorder(&recording);
+        }
+
+        if (isLoaded && !recordsFileName.empty())
+        {
+            MappedFile records;
+
+            if (records.open(recordsFileName))
+            {
+                RecordRunner runner(interpreter.getProgram(), totalThreads);
+
+                if (isSeeded)
+                    runner.setSeed(seed);
+
+                runner.setLimits(limits);
+
+                isDone = (0 == runner.run(
+                    records.getData(), records.getSize(), std::cout, std::cerr));
+            }
+            else
+            {
+                std::cerr << "Cannot open \"" << recordsFileName << "\"!\n";
+            }
+        }
+        else if (isLoaded)
+        {
+            s_interpreter = &interpreter;
+#ifdef SIGUSR1
+            std::signal(SIGUSR1, requestCheckpoint);
+#endif
+#ifdef SIGUSR2
+            std::signal(SIGUSR2, requestTrace);
+#endif
+            if (!metricsFileName.empty())
+            {
+                interpreter.enableMetrics();
+                interpreter.getMetrics().startDump(metricsFileName, metricsInterval);
+            }
+
+            isDone = interpreter.run();
+            s_interpreter = nullptr;
+
+            // A failed run is worth replaying as much as any.
+            if (!recordFileName.empty() && replayFileName.empty())
+                recording.write(recordFileName, interpreter.getProgram(), std::cerr);
+
+            if (!metricsFileName.empty())
+                interpreter.getMetrics().stopDump();
+
+            if (profile)
+                writeReport(profiler, profileFileName, interpreter.getProgram());
+            else if (0 != sampleRate)
+                writeReport(sampler, sampleFileName, interpreter.getProgram());
+            else if (allocationProfile)
+                writeReport(allocationProfiler, allocationProfileFileName, interpreter.getProgram());
+        }
     }
     else
     {
         std::cerr << "Cannot open \"" << fileName << "\"!\n";
     }
 
+#ifdef _WIN32
     if (!fileNamePassedAsParameter)
     {
         std::cout << "Press space bar to exit...\n";
@@ -84,6 +661,9 @@ int main(int argc, char* argv[])
                 ((::GetKeyState(VK_SPACE) & 0x8000) != 0)))
             ::Sleep(0);
     }
+#else
+    (void)fileNamePassedAsParameter;
+#endif
 
-    return 0;
+    return isDone ? 0 : 1;
 }